@@ -0,0 +1,115 @@
+/*
+Benchmark for the cost partitioning of the landmark heuristic.
+
+For one task of every domain in a benchmark directory (e.g.
+docs/benchmarks), run A* once with the uniform cost partitioning and once
+with the optimal cost partitioning (one LP per evaluated state) and report
+the initial h value, the number of evaluated states, the search time and
+the plan length of both, i.e. how much search the LP saves and how much
+time per state it costs.
+
+usage: bench_landmarks <benchmarks-dir> [task id]
+*/
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "myplan/grounding.h"
+#include "myplan/heuristic/landmarks.h"
+#include "myplan/pddl/parser.h"
+#include "myplan/search/astar.h"
+#include "myplan/task.h"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+struct BenchResult {
+    float initial_h;
+    long evaluations;
+    double seconds;
+    int plan_length;
+};
+
+// Forwards to a heuristic and counts its evaluations
+struct CountingHeuristic : Heuristic {
+    Heuristic& heuristic;
+    long evaluations = 0;
+    float initial_h = 0;
+
+    CountingHeuristic(Heuristic& heuristic) : heuristic(heuristic) {}
+
+    void initialize(SearchSpace& space) { heuristic.initialize(space); }
+
+    float calculate_h(const PackedState& state, StateID id,
+                      SearchSpace& space) {
+        float h = heuristic.calculate_h(state, id, space);
+        if (evaluations++ == 0) {
+            initial_h = h;
+        }
+        return h;
+    }
+};
+
+BenchResult run(Task& task, Heuristic& heuristic) {
+    CountingHeuristic counter(heuristic);
+    // silence the progress output of the search
+    std::ostringstream sink;
+    std::streambuf* cout_buffer = std::cout.rdbuf(sink.rdbuf());
+    auto start = chrono::steady_clock::now();
+    std::vector<int> plan = astar(task, counter);
+    auto end = chrono::steady_clock::now();
+    std::cout.rdbuf(cout_buffer);
+    return {counter.initial_h, counter.evaluations,
+            chrono::duration<double>(end - start).count(), (int)plan.size()};
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printf("Usage: %s <benchmarks-dir> [task id]\n", argv[0]);
+        return 1;
+    }
+    fs::path benchmarks_dir = argv[1];
+    string task_id = argc > 2 ? argv[2] : "01";
+
+    std::vector<fs::path> domain_dirs;
+    for (auto& entry : fs::directory_iterator(benchmarks_dir)) {
+        if (entry.is_directory()) {
+            domain_dirs.push_back(entry.path());
+        }
+    }
+    std::sort(domain_dirs.begin(), domain_dirs.end());
+
+    printf("%-14s %6s %6s %10s %10s %9s %9s %6s %6s\n", "domain", "h0 uni",
+           "h0 ocp", "evals uni", "evals ocp", "time uni", "time ocp",
+           "len", "len");
+    for (fs::path& dir : domain_dirs) {
+        fs::path problem_file = dir / ("task" + task_id + ".pddl");
+        fs::path domain_file = dir / ("domain" + task_id + ".pddl");
+        if (!fs::exists(domain_file)) {
+            domain_file = dir / "domain.pddl";
+        }
+        if (!fs::exists(problem_file) || !fs::exists(domain_file)) {
+            continue;
+        }
+
+        Parser parser = Parser(domain_file.string(), problem_file.string());
+        Domain* domain = parser.parse_domain(true);
+        Problem problem = *parser.parse_problem(domain, true);
+        Task task = ground(problem);
+
+        LandmarkHeuristic uniform_heuristic(task);
+        BenchResult uniform = run(task, uniform_heuristic);
+        OptimalLandmarkHeuristic optimal_heuristic(task);
+        BenchResult optimal = run(task, optimal_heuristic);
+        printf("%-14s %6.1f %6.1f %10ld %10ld %8.3fs %8.3fs %6d %6d\n",
+               dir.filename().c_str(), uniform.initial_h, optimal.initial_h,
+               uniform.evaluations, optimal.evaluations, uniform.seconds,
+               optimal.seconds, uniform.plan_length, optimal.plan_length);
+        fflush(stdout);
+    }
+}
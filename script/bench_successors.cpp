@@ -0,0 +1,167 @@
+/*
+Microbenchmark for successor generation.
+
+For the first task of every domain in a benchmark directory (e.g.
+docs/benchmarks), expand states in breadth-first order and report how many
+successors per second are generated, once with the string-based hash update
+that the planner used before Zobrist hashing and once with the Zobrist keys
+of the task.
+
+usage: bench_successors <benchmarks-dir> [expansions per task] [task id]
+*/
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "myplan/grounding.h"
+#include "myplan/pddl/parser.h"
+#include "myplan/search/state_registry.h"
+#include "myplan/task.h"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+struct BenchResult {
+    int expansions;
+    long successors;
+    double seconds;
+};
+
+// Hash update of the previous implementation: one string per toggled fact
+inline size_t toggle_string_hash(size_t hash_val, int word_idx,
+                                 StateWord changed) {
+    while (changed) {
+        int fact = word_idx * STATE_WORD_BITS + __builtin_ctzll(changed);
+        hash_val ^= std::hash<std::string>{}(std::to_string(fact));
+        changed &= changed - 1;
+    }
+    return hash_val;
+}
+
+inline size_t string_hash_state(const PackedState& state) {
+    size_t hash_val = 0;
+    for (int w = 0; w < state.num_words(); w++) {
+        hash_val = toggle_string_hash(hash_val, w, state.words[w]);
+    }
+    return hash_val;
+}
+
+inline void apply_with_string_hash(const OperatorTable& operators, int op,
+                                   const PackedState& state,
+                                   pair<size_t, PackedState>& result,
+                                   size_t hash_val) {
+    result.second.words.assign(state.words.begin(), state.words.end());
+    for (int fact : operators.del_effects(op)) {
+        if (result.second.test(fact)) {
+            result.second.reset(fact);
+            hash_val ^= std::hash<std::string>{}(std::to_string(fact));
+        }
+    }
+    for (int fact : operators.add_effects(op)) {
+        if (!result.second.test(fact)) {
+            result.second.set(fact);
+            hash_val ^= std::hash<std::string>{}(std::to_string(fact));
+        }
+    }
+    result.first = hash_val;
+}
+
+template <typename HashState, typename Apply>
+BenchResult run(Task& task, int max_expansions, HashState hash_state,
+                Apply apply) {
+    StateRegistry registry(task.num_state_words);
+    PackedState state = task.get_initial_state();
+    std::queue<StateID> queue;
+    queue.push(registry.insert_state(state, hash_state(state)).first);
+
+    std::vector<int> applicable_operators;
+    std::vector<pair<size_t, PackedState>> successors;
+    long num_successors = 0;
+    int expansions = 0;
+    auto start = chrono::steady_clock::now();
+    while (!queue.empty() && expansions < max_expansions) {
+        StateID id = queue.front();
+        queue.pop();
+        expansions++;
+        registry.unpack(id, state);
+        task.get_applicable_operators(state, applicable_operators);
+        if (successors.size() < applicable_operators.size()) {
+            successors.resize(applicable_operators.size());
+        }
+        for (size_t i = 0; i < applicable_operators.size(); i++) {
+            apply(applicable_operators[i], state, successors[i],
+                  registry.get_hash(id));
+            auto [succ_id, is_new] = registry.insert_state(
+                successors[i].second, successors[i].first);
+            if (is_new) {
+                queue.push(succ_id);
+            }
+        }
+        num_successors += applicable_operators.size();
+    }
+    auto end = chrono::steady_clock::now();
+    return {expansions, num_successors, chrono::duration<double>(end - start).count()};
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printf("Usage: %s <benchmarks-dir> [expansions] [task id]\n", argv[0]);
+        return 1;
+    }
+    fs::path benchmarks_dir = argv[1];
+    int max_expansions = argc > 2 ? stoi(argv[2]) : 20000;
+    string task_id = argc > 3 ? argv[3] : "01";
+
+    std::vector<fs::path> domain_dirs;
+    for (auto& entry : fs::directory_iterator(benchmarks_dir)) {
+        if (entry.is_directory()) {
+            domain_dirs.push_back(entry.path());
+        }
+    }
+    std::sort(domain_dirs.begin(), domain_dirs.end());
+
+    printf("%-14s %10s %10s %14s %14s %8s\n", "domain", "expanded",
+           "successors", "string [M/s]", "zobrist [M/s]", "speedup");
+    for (fs::path& dir : domain_dirs) {
+        fs::path problem_file = dir / ("task" + task_id + ".pddl");
+        fs::path domain_file = dir / ("domain" + task_id + ".pddl");
+        if (!fs::exists(domain_file)) {
+            domain_file = dir / "domain.pddl";
+        }
+        if (!fs::exists(problem_file) || !fs::exists(domain_file)) {
+            continue;
+        }
+
+        Parser parser = Parser(domain_file.string(), problem_file.string());
+        Domain* domain = parser.parse_domain(true);
+        Problem problem = *parser.parse_problem(domain, true);
+        Task task = ground(problem);
+
+        BenchResult legacy = run(
+            task, max_expansions, string_hash_state,
+            [&task](int op, const PackedState& s,
+                    pair<size_t, PackedState>& result, size_t hash_val) {
+                apply_with_string_hash(task.operators, op, s, result,
+                                       hash_val);
+            });
+        BenchResult zobrist = run(
+            task, max_expansions,
+            [&task](const PackedState& s) { return task.hash_state(s); },
+            [&task](int op, const PackedState& s,
+                    pair<size_t, PackedState>& result, size_t hash_val) {
+                task.operators.apply(op, s, result, hash_val,
+                                     task.zobrist_keys);
+            });
+        double legacy_rate = legacy.successors / legacy.seconds / 1e6;
+        double zobrist_rate = zobrist.successors / zobrist.seconds / 1e6;
+        printf("%-14s %10d %10ld %14.3f %14.3f %7.2fx\n",
+               dir.filename().c_str(), zobrist.expansions, zobrist.successors,
+               legacy_rate, zobrist_rate, zobrist_rate / legacy_rate);
+    }
+}
@@ -6,6 +6,7 @@
 #include <future>
 #include <iostream>
 #include <limits>
+#include <memory>
 #include <numeric>
 #include <stdexcept>
 #include <string>
@@ -16,10 +17,14 @@
 #include "myplan/grounding.h"
 #include "myplan/heuristic/base.h"
 #include "myplan/heuristic/landmarks.h"
+#include "myplan/heuristic/lmcut.h"
+#include "myplan/heuristic/pdb.h"
 #include "myplan/heuristic/relaxation.h"
 #include "myplan/pddl/parser.h"
 #include "myplan/search/astar.h"
 #include "myplan/search/breadth_first_search.h"
+#include "myplan/search/greedy_best_first_search.h"
+#include "myplan/search/lazy_search.h"
 
 using namespace std;
 
@@ -28,12 +33,16 @@ string heuristic_type = "blind";
 string domain_file_path = "domain.pddl";
 string problem_file_path = "task.pddl";
 string solution_file_path = "task.soln";
+int weight = 5;
+bool lazy_evaluation = false;
+bool preferred_operators = false;
+int cost_bound = numeric_limits<int>::max();
 
 void parse_args(int argc, char* argv[]) {
     int opt;
     domain_file_path = argv[1];
     problem_file_path = argv[2];
-    while ((opt = getopt(argc, argv, "s:H:o:")) != -1) {
+    while ((opt = getopt(argc, argv, "s:H:o:w:lpb:")) != -1) {
         switch (opt) {
             case 's':
                 search_algorithm = string(optarg);
@@ -44,14 +53,52 @@ void parse_args(int argc, char* argv[]) {
             case 'o':
                 solution_file_path = string(optarg);
                 break;
+            case 'w':
+                weight = stoi(string(optarg));
+                break;
+            case 'l':
+                lazy_evaluation = true;
+                break;
+            case 'p':
+                preferred_operators = true;
+                break;
+            case 'b':
+                cost_bound = stoi(string(optarg));
+                break;
             default:
                 printf("unknown parameter %s is specified", optarg);
-                printf("Usage: %s [-s] [-H] [-o] ...\n", argv[0]);
+                printf(
+                    "Usage: %s [-s] [-H] [-o] [-w] [-l] [-p] "
+                    "[-b (astar and eager wastar only)] ...\n",
+                    argv[0]);
                 break;
         }
     }
 }
 
+unique_ptr<Heuristic> make_heuristic(Task& task) {
+    if (heuristic_type == "blind") {
+        return make_unique<BlindHeuristic>(task);
+    } else if (heuristic_type == "goalcount") {
+        return make_unique<GoalCountHeuristic>(task);
+    } else if (heuristic_type == "landmark") {
+        return make_unique<LandmarkHeuristic>(task);
+    } else if (heuristic_type == "landmark-ocp") {
+        return make_unique<OptimalLandmarkHeuristic>(task);
+    } else if (heuristic_type == "hadd") {
+        return make_unique<hAddHeuristic>(task);
+    } else if (heuristic_type == "hff") {
+        return make_unique<hFFHeuristic>(task);
+    } else if (heuristic_type == "hmax") {
+        return make_unique<hMaxHeuristic>(task);
+    } else if (heuristic_type == "lmcut") {
+        return make_unique<LmCutHeuristic>(task);
+    } else if (heuristic_type == "pdb") {
+        return make_unique<PDBHeuristic>(task);
+    }
+    throw invalid_argument("given heuristic type is not supported");
+}
+
 int main(int argc, char* argv[]) {
     parse_args(argc, argv);
 
@@ -74,42 +121,58 @@ int main(int argc, char* argv[]) {
     Task task = ground(problem);
     printf("Grounding end: %s \n", problem.name.c_str());
     printf("%d Variables created \n", (int)task.facts.size());
+    printf("%d Finite-domain variables synthesized (%d bits, %d words) \n",
+           task.variables.size(), task.variables.packed_bits(),
+           task.variables.packed_words());
     printf("%d Operators created \n", (int)task.operators.size());
-    printf("%d Keys registered \n", (int)task.encoding_map.size());
+    printf("%d Symbols interned \n",
+           task.symbols.predicates.size() + task.symbols.objects.size() +
+               task.symbols.types.size() + task.symbols.actions.size());
 
     printf("Search start: %s \n", task.name.c_str());
     chrono::system_clock::time_point start, end;
     vector<int> solution;
+    if (cost_bound != numeric_limits<int>::max() &&
+        (lazy_evaluation ||
+         (search_algorithm != "astar" && search_algorithm != "wastar"))) {
+        throw invalid_argument(
+            "a cost bound is only used by astar and eager wastar");
+    }
     if (search_algorithm == "bfs") {
         start = chrono::system_clock::now();
         solution = breadth_first_search(task);
-    } else if (search_algorithm == "astar") {
-        if (heuristic_type == "blind") {
-            BlindHeuristic heuristic(task);
-            start = chrono::system_clock::now();
-            solution = astar(task, heuristic);
-        } else if (heuristic_type == "goalcount") {
-            GoalCountHeuristic heuristic(task);
-            start = chrono::system_clock::now();
-            solution = astar(task, heuristic);
-        } else if (heuristic_type == "landmark") {
-            LandmarkHeuristic heuristic(task);
-            start = chrono::system_clock::now();
-            solution = astar(task, heuristic);
-
-        } else if (heuristic_type == "hadd") {
-            hAddHeuristic heuristic(task);
-            start = chrono::system_clock::now();
-            solution = astar(task, heuristic);
-        } else if (heuristic_type == "hmax") {
-            hMaxHeuristic heuristic(task);
-            start = chrono::system_clock::now();
-            solution = astar(task, heuristic);
+    } else {
+        unique_ptr<Heuristic> heuristic = make_heuristic(task);
+        if (preferred_operators &&
+            (search_algorithm == "astar" ||
+             (search_algorithm == "wastar" && !lazy_evaluation))) {
+            throw invalid_argument(
+                "preferred operators are only used by gbfs and lazy wastar");
+        }
+        if (preferred_operators &&
+            !heuristic->supports_preferred_operators()) {
+            throw invalid_argument(
+                "given heuristic type does not support preferred operators");
+        }
+        start = chrono::system_clock::now();
+        if (search_algorithm == "astar" && !lazy_evaluation) {
+            solution =
+                astar(task, *heuristic, TieBreaking::LIFO, cost_bound);
+        } else if (search_algorithm == "gbfs" && !lazy_evaluation) {
+            solution = greedy_best_first_search(task, *heuristic,
+                                                preferred_operators);
+        } else if (search_algorithm == "gbfs") {
+            solution = lazy_greedy_best_first_search(task, *heuristic,
+                                                     preferred_operators);
+        } else if (search_algorithm == "wastar" && !lazy_evaluation) {
+            solution = weighted_astar(task, *heuristic, weight,
+                                      TieBreaking::LIFO, cost_bound);
+        } else if (search_algorithm == "wastar") {
+            solution = lazy_weighted_astar(task, *heuristic, weight,
+                                           preferred_operators);
         } else {
-            throw invalid_argument("given heuristic type is not supported");
+            throw invalid_argument("given search algorithm is not supported");
         }
-    } else {
-        throw invalid_argument("given search algorithm is not supported");
     }
     end = chrono::system_clock::now();
     float elapsed =
@@ -120,7 +183,7 @@ int main(int argc, char* argv[]) {
     ofstream solution_file;
     solution_file.open(solution_file_path, ios::out);
     for (int op : solution) {
-        solution_file << task.action_id2name[op] << "\n";
+        solution_file << task.operator_name(op) << "\n";
     }
 
     /*
@@ -5,102 +5,79 @@
 #include <map>
 #include <memory>
 #include <ranges>
-#include <regex>
+#include <sstream>
 #include <string>
 //#include <flat_hash_set>
 #include <vector>
 
+#include "mutex_groups.h"
 #include "parallel_hashmap/phmap.h"
 #include "pddl/pddl.h"
 #include "pddl/tree_visitor.h"
 #include "pddl/visitable.h"
+#include "symbols.h"
 #include "task.h"
+#include "thread_pool.h"
 
 using namespace std;
 
-inline std::vector<Operator> relevance_analysis(
-    std::vector<Operator>& operators, flat_hash_set<std::string>& goals,
-    bool verbose_logging = false) {
+// An operator of the grounding: its instance, i.e. its action and the
+// objects of the parameters, and the ids of its ground atoms
+struct _GroundOperator {
+    int instance;
+    std::vector<int> preconditions;
+    std::vector<int> add_effects;
+    std::vector<int> del_effects;
+};
+
+inline std::vector<_GroundOperator> relevance_analysis(
+    std::vector<_GroundOperator>& operators, const std::vector<int>& goals,
+    int num_atoms) {
     /* This implements a relevance analysis of operators.
      * We start with all facts within the goal and iteratively compute
      * a fixpoint of all relevant effects.
      * Relevant effects are those that contribute to a valid path to the goal.
      */
-    bool debug = true;
-    std::set<std::string> relevant_facts;
-    std::set<std::string> old_relevant_facts;
-    flat_hash_set<Predicate> debug_pruned_op;
-    bool changed = true;
-    for (const auto& goal : goals) {
-        relevant_facts.insert(goal);
+    std::vector<char> relevant_facts(num_atoms, 0);
+    for (int goal : goals) {
+        relevant_facts[goal] = 1;
     }
+    auto relevant = [&](const std::vector<int>& facts) {
+        return std::any_of(facts.begin(), facts.end(),
+                           [&](int fact) { return relevant_facts[fact]; });
+    };
 
+    bool changed = true;
     while (changed) {
-        // set next relevant facts to current facts
         // if we do not add anything in the following for loop
         // we have already found a fixpoint
-        old_relevant_facts = relevant_facts;
-        // compute cut of relevant facts with effects of all operators
-        for (const auto& op : operators) {
-            std::set<std::string> new_addlist;
-            std::set_intersection(
-                op.add_effects.begin(), op.add_effects.end(),
-                relevant_facts.begin(), relevant_facts.end(),
-                std::inserter(new_addlist, new_addlist.end()));
-            std::set<std::string> new_dellist;
-            std::set_intersection(
-                op.del_effects.begin(), op.del_effects.end(),
-                relevant_facts.begin(), relevant_facts.end(),
-                std::inserter(new_dellist, new_dellist.end()));
-            if (!new_addlist.empty() || !new_dellist.empty()) {
+        changed = false;
+        for (const _GroundOperator& op : operators) {
+            if (relevant(op.add_effects) || relevant(op.del_effects)) {
                 // add all preconditions to relevant facts
-                relevant_facts.insert(op.preconditions.begin(),
-                                      op.preconditions.end());
-            }
-        }
-        changed = old_relevant_facts != relevant_facts;
-    }
-
-    // delete all irrelevant effects
-    flat_hash_set<Operator> del_operators;
-    for (auto& op : operators) {
-        // calculate new effects
-        std::set<std::string> new_addlist;
-        std::set_intersection(op.add_effects.begin(), op.add_effects.end(),
-                              relevant_facts.begin(), relevant_facts.end(),
-                              std::inserter(new_addlist, new_addlist.end()));
-        std::set<std::string> new_dellist;
-        std::set_intersection(op.del_effects.begin(), op.del_effects.end(),
-                              relevant_facts.begin(), relevant_facts.end(),
-                              std::inserter(new_dellist, new_dellist.end()));
-        // if (debug) {
-        //     debug_pruned_op.insert(op.add_effects.begin(),
-        //                            op.add_effects.end());
-        //     debug_pruned_op.insert(op.del_effects.begin(),
-        //                            op.del_effects.end());
-        // }
-        //  store new effects
-        op.add_effects = new_addlist;
-        op.del_effects = new_dellist;
-        if (new_addlist.empty() && new_dellist.empty()) {
-            // if (verbose_logging) {
-            //     std::cout << "Relevance analysis removed oparator " <<
-            //     op.name
-            //               << std::endl;
-            // }
-            del_operators.insert(op);
-        }
-    }
-    // if (debug) {
-    //    std::cout << "Relevance analysis removed " << debug_pruned_op.size()
-    //              << " facts" << std::endl;
-    //}
-    // remove completely irrelevant operators
-    std::vector<Operator> new_operators;
-    new_operators.reserve(operators.size() - del_operators.size());
-    for (const auto& op : operators) {
-        if (!del_operators.count(op)) {
-            new_operators.push_back(op);
+                for (int fact : op.preconditions) {
+                    if (!relevant_facts[fact]) {
+                        relevant_facts[fact] = 1;
+                        changed = true;
+                    }
+                }
+            }
+        }
+    }
+
+    // delete all irrelevant effects and remove completely irrelevant
+    // operators
+    std::vector<_GroundOperator> new_operators;
+    auto irrelevant = [&](int fact) { return !relevant_facts[fact]; };
+    for (_GroundOperator& op : operators) {
+        op.add_effects.erase(std::remove_if(op.add_effects.begin(),
+                                            op.add_effects.end(), irrelevant),
+                             op.add_effects.end());
+        op.del_effects.erase(std::remove_if(op.del_effects.begin(),
+                                            op.del_effects.end(), irrelevant),
+                             op.del_effects.end());
+        if (!op.add_effects.empty() || !op.del_effects.empty()) {
+            new_operators.push_back(std::move(op));
         }
     }
     return new_operators;
@@ -199,32 +176,6 @@ std::string _get_grounded_string(std::string name,
     return "(" + name + args_string + ")";
 }
 
-// Helper function to ground atom
-std::string _ground_atom(
-    const Predicate& atom,
-    const std::unordered_map<std::string, std::string>& assignment) {
-    std::vector<std::string> names;
-    for (auto [name, types] : atom.signature) {
-        if (assignment.count(name)) {
-            names.push_back(assignment.at(name));
-        } else {
-            names.push_back(name);
-        }
-    }
-    return _get_grounded_string(atom.name, names);
-}
-
-// Helper function to ground atoms
-inline flat_hash_set<std::string> _ground_atoms(
-    const set<Predicate>& atoms,
-    const std::unordered_map<std::string, std::string>& assignment) {
-    flat_hash_set<std::string> grounded_atoms;
-    for (auto atom : atoms) {
-        grounded_atoms.insert(_ground_atom(atom, assignment));
-    }
-    return grounded_atoms;
-}
-
 // Helper function to get fact string
 inline std::string _get_fact(const Predicate& atom) {
     std::vector<std::string> args;
@@ -244,349 +195,1124 @@ inline flat_hash_set<string> _get_partial_state(
     return partial_state;
 }
 
-inline bool _find_pred_in_init(string pred_name, string param, int sig_pos,
-                               flat_hash_set<std::string> init) {
+struct _GroundAtom {
+    std::string predicate;
+    std::vector<std::string> args;
+};
+
+// Split a grounded fact such as "(at truck1 locA )" into its parts
+inline _GroundAtom _parse_ground_atom(const std::string& fact) {
+    _GroundAtom atom;
+    std::string inner = fact;
+    if (!inner.empty() && inner.front() == '(') {
+        inner = inner.substr(1);
+    }
+    if (!inner.empty() && inner.back() == ')') {
+        inner.pop_back();
+    }
+    std::istringstream tokens(inner);
+    tokens >> atom.predicate;
+    std::string arg;
+    while (tokens >> arg) {
+        atom.args.push_back(arg);
+    }
+    return atom;
+}
+
+class AtomIndex {
     /*
-    This method is used to check whether an instantiation of the predicate
-    denoted by pred_name with the parameter param at position sig_pos is
-    present in the initial condition.
-    Useful to evaluate static preconditions efficiently.
+    A set of the ground atoms of a GroundAtomTable as one relation per
+    predicate, indexed by (predicate, argument position, object), so that
+    preconditions can be checked and joined with lookups of ints:
+    contains() tells whether a ground atom is in the set, has_argument()
+    whether any atom of a predicate has a given object at a given position,
+    and matching() lists these atoms.
+
+    The table must outlive the index; atoms that are added to the table
+    later are not in the set until they are inserted.
     */
-    regex match_init;
-    if (sig_pos == 0) {
-        match_init = regex("\\(" + pred_name + " " + param + ".*");
-    } else {
-        string reg_ex = "\\(" + pred_name + "\\s+";
-        for (int i = 0; i < sig_pos; i++) {
-            reg_ex += "[\\w\\d-]+\\s+";
+   public:
+    explicit AtomIndex(const GroundAtomTable& table) : table(&table) {}
+
+    AtomIndex(const GroundAtomTable& table, const std::vector<int>& atoms)
+        : table(&table) {
+        for (int atom : atoms) {
+            insert(atom);
         }
-        reg_ex += param + ".*";
-        match_init = regex(reg_ex);
     }
-    for (string str : init) {
-        if (regex_match(str, match_init)) {
-            return true;
+
+    // Add the atom "atom" of the table, false if it was in the set already
+    bool insert(int atom) {
+        if (contains(atom)) {
+            return false;
+        }
+        if (atom >= (int)member.size()) {
+            member.resize(atom + 1, 0);
+        }
+        member[atom] = 1;
+        num_atoms++;
+        int predicate = table->symbol(atom);
+        if (predicate >= (int)relations.size()) {
+            relations.resize(predicate + 1);
         }
+        Relation& relation = relations[predicate];
+        int arity = table->arity(atom);
+        if ((int)relation.by_argument.size() < arity) {
+            relation.by_argument.resize(arity);
+        }
+        for (int pos = 0; pos < arity; pos++) {
+            relation.by_argument[pos][table->args(atom)[pos]].push_back(atom);
+        }
+        relation.atoms.push_back(atom);
+        return true;
+    }
+
+    bool contains(int atom) const {
+        return atom >= 0 && atom < (int)member.size() && member[atom];
+    }
+
+    bool contains(int predicate, const int* args, int arity) const {
+        return contains(table->find(predicate, args, arity));
+    }
+
+    bool has_argument(int predicate, int position, int object) const {
+        return !matching(predicate, position, object).empty();
+    }
+
+    // The atoms of "predicate" with "object" at "position"
+    const std::vector<int>& matching(int predicate, int position,
+                                     int object) const {
+        static const std::vector<int> none;
+        if (predicate >= (int)relations.size() ||
+            position >= (int)relations[predicate].by_argument.size()) {
+            return none;
+        }
+        const flat_hash_map<int, std::vector<int>>& objects =
+            relations[predicate].by_argument[position];
+        auto it = objects.find(object);
+        return it == objects.end() ? none : it->second;
+    }
+
+    // The atoms of "predicate" in the order of their insertion
+    const std::vector<int>& atoms(int predicate) const {
+        static const std::vector<int> none;
+        return predicate < (int)relations.size() ? relations[predicate].atoms
+                                                 : none;
+    }
+
+    const GroundAtomTable& atom_table() const { return *table; }
+
+    bool empty() const { return num_atoms == 0; }
+
+   private:
+    struct Relation {
+        std::vector<int> atoms;
+        // per argument position the atoms with each object there
+        std::vector<flat_hash_map<int, std::vector<int>>> by_argument;
+    };
+
+    const GroundAtomTable* table;
+    std::vector<char> member;  // per atom of the table
+    int num_atoms = 0;
+    std::vector<Relation> relations;  // per predicate
+};
+
+struct _LiftedAtom {
+    // an atom of an action: per argument the index of the parameter there,
+    // or -1 for the constant there
+    int predicate;
+    std::vector<int> params;
+    std::vector<int> constants;
+};
+
+// The objects of the arguments of "atom" with the parameters "values"
+inline void _instantiate(const _LiftedAtom& atom,
+                         const std::vector<int>& values,
+                         std::vector<int>& args) {
+    args.resize(atom.params.size());
+    for (size_t j = 0; j < atom.params.size(); j++) {
+        int param = atom.params[j];
+        args[j] = param < 0 ? atom.constants[j] : values[param];
     }
-    return false;
 }
 
-template <typename T>
-inline std::vector<std::vector<T>> product(
-    const std::vector<std::vector<T>>& iterables) {
-    std::vector<std::vector<T>> results;
+class _AssignmentEnumerator {
+    /*
+    Enumerate the assignments of the parameters of an action that satisfy
+    a set of its preconditions as a join of the relations of an AtomIndex.
+    The parameters are bound one at a time, and every condition is checked
+    as soon as all of its parameters are bound. If a condition of the next
+    parameter has an argument that is bound already, only the objects of
+    the matching atoms are tried (an index nested-loop join), otherwise all
+    objects of the type of the parameter. Parameters that can be joined are
+    bound first, then those with the fewest objects. The objects of the
+    "prebound" parameters are given to every enumeration.
+
+    The enumerator is not changed by an enumeration, which keeps the
+    partial assignment in a buffer of the caller, so several threads can
+    use it at the same time.
+
+    Only the current partial assignment is kept, so memory stays
+    proportional to the output and not to the cross product of the
+    parameter domains.
+    */
+   public:
+    _AssignmentEnumerator(std::vector<std::vector<int>> domains,
+                          std::vector<_LiftedAtom> conditions,
+                          const AtomIndex& atoms,
+                          const std::vector<int>& prebound = {})
+        : domains(std::move(domains)),
+          conditions(std::move(conditions)),
+          atoms(atoms) {
+        int n = (int)this->domains.size();
+        for (std::vector<int>& domain : this->domains) {
+            std::sort(domain.begin(), domain.end());
+            domain_sets.emplace_back(domain.begin(), domain.end());
+        }
+        depth_of.assign(n, n);
+        for (int param : prebound) {
+            depth_of[param] = -1;
+        }
+        for (int c = 0; c < (int)this->conditions.size(); c++) {
+            const std::vector<int>& params = this->conditions[c].params;
+            if (std::all_of(params.begin(), params.end(), [&](int param) {
+                    return bound_before(param, 0);
+                })) {
+                initial_checks.push_back(c);
+            }
+        }
+        for (int d = 0; d < n - (int)prebound.size(); d++) {
+            choose_parameter(d);
+        }
+    }
+
+    int num_parameters() const { return (int)domains.size(); }
+
+    // Whether "object" is of the type of "param"
+    bool in_domain(int param, int object) const {
+        return domain_sets[param].count(object) > 0;
+    }
 
-    for (std::vector<T> vec : iterables) {
-        if (vec.size() == 0) {
-            return results;
+    /*
+    Call "callback" with the objects of the parameters of every assignment.
+    "values" holds the objects of the prebound parameters and has one entry
+    per parameter; the others are overwritten.
+    */
+    template <typename Callback>
+    void for_each(std::vector<int>& values, Callback&& callback) const {
+        if (satisfied(initial_checks, values)) {
+            extend(0, values, callback);
         }
     }
 
-    if (iterables.empty()) {
-        results.push_back({});
-        return results;
+   private:
+    struct Join {
+        int condition = -1;
+        int position;  // of the parameter in the condition
+        int key;       // a bound argument of the condition
+    };
+
+    std::vector<std::vector<int>> domains;
+    std::vector<flat_hash_set<int>> domain_sets;
+    std::vector<_LiftedAtom> conditions;
+    const AtomIndex& atoms;
+
+    std::vector<int> order;     // the parameter bound at every depth
+    std::vector<int> depth_of;  // per parameter, -1 if prebound
+    std::vector<Join> joins;    // per depth
+    std::vector<std::vector<int>> checks;  // conditions complete per depth
+    std::vector<int> initial_checks;       // conditions complete initially
+
+    bool bound_before(int param, int depth) const {
+        return param < 0 || depth_of[param] < depth;
     }
-    std::vector<size_t> counters(iterables.size());
-    std::vector<size_t> sizes(iterables.size());
-    for (size_t i = 0; i < iterables.size(); ++i) {
-        sizes[i] = iterables[i].size();
+
+    // A join of "param" at "depth", if one of its conditions allows one
+    Join find_join(int param, int depth) const {
+        Join join;
+        for (int c = 0; c < (int)conditions.size(); c++) {
+            const std::vector<int>& params = conditions[c].params;
+            auto it = std::find(params.begin(), params.end(), param);
+            if (it == params.end()) {
+                continue;
+            }
+            for (int j = 0; j < (int)params.size(); j++) {
+                if (params[j] != param && bound_before(params[j], depth)) {
+                    join.condition = c;
+                    join.position = (int)(it - params.begin());
+                    join.key = j;
+                    return join;
+                }
+            }
+        }
+        return join;
     }
-    while (true) {
-        std::vector<T> result;
-        for (size_t i = 0; i < iterables.size(); ++i) {
-            result.push_back(iterables[i][counters[i]]);
-        }
-        results.push_back(result);
-        size_t j = iterables.size() - 1;
-        while (j != -1) {
-            counters[j] += 1;
-            if (counters[j] == sizes[j]) {
-                counters[j] = 0;
-                j -= 1;
-            } else {
-                break;
+
+    void choose_parameter(int depth) {
+        int best = -1;
+        bool best_joined = false;
+        for (int p = 0; p < (int)domains.size(); p++) {
+            if (depth_of[p] < depth) {
+                continue;
+            }
+            bool joined = find_join(p, depth).condition >= 0;
+            if (best < 0 || joined > best_joined ||
+                (joined == best_joined &&
+                 domains[p].size() < domains[best].size())) {
+                best = p;
+                best_joined = joined;
             }
         }
-        if (j == -1) {
-            break;
+        joins.push_back(find_join(best, depth));
+        order.push_back(best);
+        depth_of[best] = depth;
+        checks.emplace_back();
+        for (int c = 0; c < (int)conditions.size(); c++) {
+            const std::vector<int>& params = conditions[c].params;
+            bool complete = std::all_of(
+                params.begin(), params.end(),
+                [&](int param) { return bound_before(param, depth + 1); });
+            bool contains_best =
+                std::find(params.begin(), params.end(), best) != params.end();
+            if (complete && contains_best) {
+                checks[depth].push_back(c);
+            }
         }
     }
-    return results;
-}
 
-inline Operator* _create_operator(
-    Action* action, std::unordered_map<std::string, std::string>& assignment,
-    flat_hash_set<std::string>& statics, flat_hash_set<std::string>& init) {
-    flat_hash_set<std::string> precondition_facts;
-    for (Predicate precondition : action->precondition) {
-        std::string fact = _ground_atom(precondition, assignment);
-        std::string predicate_name = precondition.name;
-        if (statics.count(predicate_name) > 0) {
-            // Check if this precondition is false in the initial state
-            if (init.count(fact) == 0) {
-                // This precondition is never true -> Don't add operator
-                return nullptr;
+    int argument(const _LiftedAtom& condition, int j,
+                 const std::vector<int>& values) const {
+        int param = condition.params[j];
+        return param < 0 ? condition.constants[j] : values[param];
+    }
+
+    bool satisfied(const std::vector<int>& to_check,
+                   const std::vector<int>& values) const {
+        // the arguments of the common short conditions stay on the stack
+        const int num_local = 8;
+        int local[num_local];
+        std::vector<int> long_args;
+        for (int c : to_check) {
+            const _LiftedAtom& condition = conditions[c];
+            int arity = (int)condition.params.size();
+            int* args = local;
+            if (arity > num_local) {
+                long_args.resize(arity);
+                args = long_args.data();
+            }
+            for (int j = 0; j < arity; j++) {
+                args[j] = argument(condition, j, values);
+            }
+            if (!atoms.contains(condition.predicate, args, arity)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // The objects of the atoms that match the bound arguments of the join
+    std::vector<int> joined_objects(int depth,
+                                    const std::vector<int>& values) const {
+        int param = order[depth];
+        const Join& join = joins[depth];
+        const _LiftedAtom& condition = conditions[join.condition];
+        const GroundAtomTable& table = atoms.atom_table();
+        std::vector<int> objects;
+        for (int atom :
+             atoms.matching(condition.predicate, join.key,
+                            argument(condition, join.key, values))) {
+            if (table.arity(atom) != (int)condition.params.size()) {
+                continue;
+            }
+            const int* tuple = table.args(atom);
+            int object = tuple[join.position];
+            bool consistent = domain_sets[param].count(object) > 0;
+            for (int j = 0; consistent && j < table.arity(atom); j++) {
+                int other = condition.params[j];
+                if (other == param) {
+                    consistent = tuple[j] == object;
+                } else if (bound_before(other, depth)) {
+                    consistent = tuple[j] == argument(condition, j, values);
+                }
             }
+            if (consistent) {
+                objects.push_back(object);
+            }
+        }
+        std::sort(objects.begin(), objects.end());
+        objects.erase(std::unique(objects.begin(), objects.end()),
+                      objects.end());
+        return objects;
+    }
+
+    template <typename Callback>
+    void extend(int depth, std::vector<int>& values,
+                Callback& callback) const {
+        if (depth == (int)order.size()) {
+            callback(values);
+            return;
+        }
+        int param = order[depth];
+        auto try_objects = [&](const std::vector<int>& objects) {
+            for (int object : objects) {
+                values[param] = object;
+                if (satisfied(checks[depth], values)) {
+                    extend(depth + 1, values, callback);
+                }
+            }
+        };
+        if (joins[depth].condition >= 0) {
+            try_objects(joined_objects(depth, values));
         } else {
-            // This precondition is not always true -> Add it
-            precondition_facts.insert(fact);
+            try_objects(domains[param]);
         }
     }
+};
+
+// An action over symbol ids
+struct _LiftedAction {
+    int symbol;
+    std::vector<std::vector<int>> types;  // per parameter
+    std::vector<_LiftedAtom> preconditions;
+    std::vector<_LiftedAtom> add_effects;
+    std::vector<_LiftedAtom> del_effects;
+};
 
-    flat_hash_set<std::string> add_effects =
-        _ground_atoms(action->effect.addlist, assignment);
-    flat_hash_set<std::string> del_effects =
-        _ground_atoms(action->effect.dellist, assignment);
-    // If the same fact is added and deleted by an operator the STRIPS formalism
-    // adds it.
-    for (std::string fact : add_effects) {
-        if (del_effects.count(fact) > 0) {
-            del_effects.erase(fact);
+class _Grounding {
+    /*
+    The grounding of a task over integer symbols. The names of the
+    predicates, objects, types and actions are interned once, when the
+    grounding is set up, and every ground atom is a predicate id with a
+    tuple of object ids in "atoms". Likewise an operator is identified by
+    its instance, an action with the objects of its parameters, in
+    "instances", so grounding compares and hashes ints and never builds a
+    string; names are only spelled out for output.
+    */
+   public:
+    Symbols symbols;
+    GroundAtomTable atoms;
+    // the action of an instance is the index in "actions"
+    GroundAtomTable instances;
+    std::vector<_LiftedAction> actions;
+    std::vector<std::vector<int>> objects_of_type;
+    std::vector<int> initial_state;
+
+    _Grounding(
+        const std::vector<Action>& actions,
+        const std::unordered_map<std::string, std::vector<std::string>>&
+            type_map,
+        const std::vector<std::string>& statics,
+        const std::vector<Predicate>& init) {
+        declare(actions, type_map, statics);
+        for (const Predicate& atom : init) {
+            initial_state.push_back(intern_atom(atom));
         }
+        index_initial_state();
     }
-    // If a fact is present in the precondition, we do not have to add it.
-    // Note that if a fact is in the delete and in the add effects,
-    // it has already been deleted in the previous step.
-    for (std::string fact : precondition_facts) {
-        if (add_effects.count(fact) > 0) {
-            add_effects.erase(fact);
+
+    _Grounding(
+        const std::vector<Action>& actions,
+        const std::unordered_map<std::string, std::vector<std::string>>&
+            type_map,
+        const std::vector<std::string>& statics,
+        const flat_hash_set<std::string>& init) {
+        declare(actions, type_map, statics);
+        std::vector<int> args;
+        for (const std::string& fact : init) {
+            _GroundAtom atom = _parse_ground_atom(fact);
+            args.clear();
+            for (const std::string& arg : atom.args) {
+                args.push_back(symbols.objects.intern(arg));
+            }
+            initial_state.push_back(
+                atoms
+                    .insert(symbols.predicates.intern(atom.predicate), args)
+                    .first);
         }
+        index_initial_state();
     }
-    std::vector<std::string> args;
-    for (auto& [name, types] : action->signature) {
-        args.push_back(assignment[name]);
+
+    _Grounding(const _Grounding&) = delete;
+    _Grounding& operator=(const _Grounding&) = delete;
+
+    // The id of the ground atom "atom", whose arguments are objects
+    int intern_atom(const Predicate& atom) {
+        std::vector<int> args;
+        for (auto& [name, types] : atom.signature) {
+            args.push_back(symbols.objects.intern(name));
+        }
+        return atoms.insert(symbols.predicates.intern(atom.name), args).first;
     }
-    std::string name = _get_grounded_string(action->name, args);
 
-    std::vector<std::string> precondition_facts_vec = std::vector<std::string>(
-        precondition_facts.begin(), precondition_facts.end());
-    std::vector<std::string> add_effects_vec =
-        std::vector<std::string>(add_effects.begin(), add_effects.end());
-    std::vector<std::string> del_effects_vec =
-        std::vector<std::string>(del_effects.begin(), del_effects.end());
+    std::vector<_GroundOperator> ground_actions(unsigned num_threads = 0);
+    std::vector<_GroundOperator> ground_reachable_actions(
+        unsigned num_threads = 0);
 
-    Operator* result = new Operator(name, precondition_facts_vec,
-                                    add_effects_vec, del_effects_vec);
-    return result;
-}
+    std::string atom_name(int atom) const {
+        return atoms.name(atom, symbols.predicates, symbols.objects);
+    }
 
-inline std::vector<Operator> _ground_action(
-    Action& action,
-    std::unordered_map<std::string, std::vector<std::string>> type_map,
-    std::vector<std::string> statics, flat_hash_set<std::string> init) {
-    std::vector<Operator> operators;
-    std::unordered_map<std::string, flat_hash_set<std::string>>
-        param_to_objects;
-
-    for (auto& [param_name, param_types] : action.signature) {
-        // List of sets of objects for this parameter
-        std::vector<std::vector<std::string>> objects;
-        for (auto& type : param_types) {
-            objects.push_back(type_map[type->name]);
-        }
-        // Combine the sets into one set
-        flat_hash_set<std::string> objects_set;
-        for (auto& object_set : objects) {
-            objects_set.insert(object_set.begin(), object_set.end());
-        }
-        param_to_objects[param_name] = objects_set;
-    }
-
-    // For each parameter that is not constant,
-    // remove all invalid static preconditions
-    int remove_debug = 0;
-    for (auto& [param, objects] : param_to_objects) {
-        for (auto& pred : action.precondition) {
-            // if a static predicate is present in the precondition
-            if (std::find(statics.begin(), statics.end(), pred.name) !=
-                statics.end()) {
-                int sig_pos = -1;
-                int count = 0;
-                // check if there is an instantiation with the current parameter
-                for (auto& [var, _] : pred.signature) {
-                    if (var == param) {
-                        sig_pos = count;
-                    }
-                    count++;
+    std::string operator_name(int instance) const;
+
+    // The operator with the names of its action and atoms
+    Operator to_operator(const _GroundOperator& op) const {
+        auto names = [this](const std::vector<int>& facts) {
+            std::vector<std::string> names;
+            for (int fact : facts) {
+                names.push_back(atom_name(fact));
+            }
+            return names;
+        };
+        std::vector<std::string> pre = names(op.preconditions);
+        std::vector<std::string> add = names(op.add_effects);
+        std::vector<std::string> del = names(op.del_effects);
+        return Operator(operator_name(op.instance), pre, add, del);
+    }
+
+    std::vector<Operator> to_operators(
+        const std::vector<_GroundOperator>& operators) const {
+        std::vector<Operator> named;
+        named.reserve(operators.size());
+        for (const _GroundOperator& op : operators) {
+            named.push_back(to_operator(op));
+        }
+        return named;
+    }
+
+   private:
+    std::vector<char> is_static;  // per predicate
+    std::unique_ptr<AtomIndex> init_index;
+    std::vector<int> args;  // a buffer for create_operator()
+
+    void declare(
+        const std::vector<Action>& domain_actions,
+        const std::unordered_map<std::string, std::vector<std::string>>&
+            type_map,
+        const std::vector<std::string>& statics) {
+        // the objects get their ids in alphabetical order
+        std::vector<std::string> objects;
+        for (auto& [type, type_objects] : type_map) {
+            objects.insert(objects.end(), type_objects.begin(),
+                           type_objects.end());
+        }
+        std::sort(objects.begin(), objects.end());
+        for (const std::string& object : objects) {
+            symbols.objects.intern(object);
+        }
+        for (auto& [type, type_objects] : type_map) {
+            std::vector<int>& ids = type_objects_of(symbols.types.intern(type));
+            for (const std::string& object : type_objects) {
+                ids.push_back(symbols.objects.find(object));
+            }
+            std::sort(ids.begin(), ids.end());
+            ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+        }
+
+        for (const std::string& predicate : statics) {
+            int id = symbols.predicates.intern(predicate);
+            if (id >= (int)is_static.size()) {
+                is_static.resize(id + 1, 0);
+            }
+            is_static[id] = 1;
+        }
+
+        for (const Action& action : domain_actions) {
+            actions.push_back(lift(action));
+        }
+    }
+
+    std::vector<int>& type_objects_of(int type) {
+        if (type >= (int)objects_of_type.size()) {
+            objects_of_type.resize(type + 1);
+        }
+        return objects_of_type[type];
+    }
+
+    void index_initial_state() {
+        init_index = std::make_unique<AtomIndex>(atoms, initial_state);
+    }
+
+    bool static_predicate(int predicate) const {
+        return predicate < (int)is_static.size() && is_static[predicate];
+    }
+
+    _LiftedAction lift(const Action& action) {
+        std::unordered_map<std::string, int> param_index;
+        _LiftedAction lifted;
+        lifted.symbol = symbols.actions.intern(action.name);
+        for (auto& [name, types] : action.signature) {
+            param_index.emplace(name, (int)param_index.size());
+            lifted.types.emplace_back();
+            for (Type* type : types) {
+                int id = symbols.types.intern(type->name);
+                type_objects_of(id);
+                lifted.types.back().push_back(id);
+            }
+        }
+        auto lift_atom = [&](const Predicate& pred) {
+            _LiftedAtom atom;
+            atom.predicate = symbols.predicates.intern(pred.name);
+            for (auto& [arg, types] : pred.signature) {
+                auto it = param_index.find(arg);
+                if (it == param_index.end()) {
+                    atom.params.push_back(-1);
+                    atom.constants.push_back(symbols.objects.intern(arg));
+                } else {
+                    atom.params.push_back(it->second);
+                    atom.constants.push_back(-1);
+                }
+            }
+            return atom;
+        };
+        for (const Predicate& pred : action.precondition) {
+            lifted.preconditions.push_back(lift_atom(pred));
+        }
+        for (const Predicate& pred : action.effect.addlist) {
+            lifted.add_effects.push_back(lift_atom(pred));
+        }
+        for (const Predicate& pred : action.effect.dellist) {
+            lifted.del_effects.push_back(lift_atom(pred));
+        }
+        return lifted;
+    }
+
+    // The objects of every parameter of "action" in the order of its
+    // signature: those of its types that occur in the static preconditions
+    // at its position
+    std::vector<std::vector<int>> parameter_domains(
+        const _LiftedAction& action) const {
+        std::vector<std::vector<int>> domains;
+        for (int param = 0; param < (int)action.types.size(); param++) {
+            // Combine the objects of all types into one set
+            std::vector<int> objects;
+            for (int type : action.types[param]) {
+                objects.insert(objects.end(), objects_of_type[type].begin(),
+                               objects_of_type[type].end());
+            }
+            std::sort(objects.begin(), objects.end());
+            objects.erase(std::unique(objects.begin(), objects.end()),
+                          objects.end());
+            // remove the objects without an instantiation of a static
+            // precondition in the initial state
+            for (const _LiftedAtom& pred : action.preconditions) {
+                if (!static_predicate(pred.predicate)) {
+                    continue;
                 }
-                if (sig_pos != -1) {
-                    // remove if no instantiation present in initial state
-                    flat_hash_set<std::string> obj_copy(objects);
-                    for (auto& o : obj_copy) {
-                        if (!_find_pred_in_init(pred.name, o, sig_pos, init)) {
-                            // if (verbose_logging) {
-                            //    remove_debug++;
-                            //}
-                            objects.erase(o);
-                        }
+                for (int pos = 0; pos < (int)pred.params.size(); pos++) {
+                    if (pred.params[pos] != param) {
+                        continue;
                     }
+                    objects.erase(
+                        std::remove_if(objects.begin(), objects.end(),
+                                       [&](int object) {
+                                           return !init_index->has_argument(
+                                               pred.predicate, pos, object);
+                                       }),
+                        objects.end());
                 }
             }
+            domains.push_back(std::move(objects));
         }
+        return domains;
     }
-    // if (verbose_logging) {
-    //     std::cout << "Static precondition analysis removed " << remove_debug
-    //               << " possible objects\n";
-    // }
 
-    // save a list of possible assignment tuples (param_name, object)
-    std::vector<std::vector<std::pair<std::string, std::string>>> domain_lists;
-    for (auto& [name, objects] : param_to_objects) {
-        std::vector<std::pair<std::string, std::string>> tuples;
-        for (auto& object : objects) {
-            tuples.emplace_back(name, object);
+    // The preconditions of "action" whose predicates satisfy "selected"
+    template <typename Selected>
+    static std::vector<_LiftedAtom> join_conditions(
+        const _LiftedAction& action, Selected selected) {
+        std::vector<_LiftedAtom> conditions;
+        for (const _LiftedAtom& pred : action.preconditions) {
+            if (selected(pred.predicate)) {
+                conditions.push_back(pred);
+            }
         }
-        domain_lists.push_back(tuples);
+        return conditions;
     }
-    // Calculate all possible assignments
-    std::vector<std::vector<std::pair<std::string, std::string>>> assignments =
-        product<std::pair<std::string, std::string>>(domain_lists);
-    flat_hash_set<std::string> statics_set(statics.begin(), statics.end());
-    // Create a new operator for each possible assignment of parameters
-    for (auto& assign : assignments) {
-        std::unordered_map<std::string, std::string> tmp_dict;
-        for (auto tmp : assign) {
-            tmp_dict.insert({tmp.first, tmp.second});
+
+    /*
+    Create the operator of the instance "instance" in "op", false if a
+    static precondition of it is false in the initial state. Static
+    preconditions are not kept, a fact that is added and deleted is added,
+    and a fact that is required is not added.
+    */
+    bool create_operator(int instance, _GroundOperator& op) {
+        const _LiftedAction& action = actions[instances.symbol(instance)];
+        const int* objects = instances.args(instance);
+        std::vector<int> values(objects, objects + instances.arity(instance));
+        op.instance = instance;
+        op.preconditions.clear();
+        for (const _LiftedAtom& pred : action.preconditions) {
+            _instantiate(pred, values, args);
+            if (static_predicate(pred.predicate)) {
+                if (!init_index->contains(pred.predicate, args.data(),
+                                          (int)args.size())) {
+                    return false;
+                }
+            } else {
+                op.preconditions.push_back(
+                    atoms.insert(pred.predicate, args).first);
+            }
+        }
+        auto ground_atoms = [&](const std::vector<_LiftedAtom>& lifted,
+                                std::vector<int>& facts) {
+            facts.clear();
+            for (const _LiftedAtom& pred : lifted) {
+                _instantiate(pred, values, args);
+                facts.push_back(atoms.insert(pred.predicate, args).first);
+            }
+            std::sort(facts.begin(), facts.end());
+            facts.erase(std::unique(facts.begin(), facts.end()), facts.end());
+        };
+        ground_atoms(action.add_effects, op.add_effects);
+        ground_atoms(action.del_effects, op.del_effects);
+        std::sort(op.preconditions.begin(), op.preconditions.end());
+        op.preconditions.erase(
+            std::unique(op.preconditions.begin(), op.preconditions.end()),
+            op.preconditions.end());
+        auto remove = [](std::vector<int>& facts,
+                         const std::vector<int>& removed) {
+            facts.erase(std::remove_if(facts.begin(), facts.end(),
+                                       [&](int fact) {
+                                           return std::binary_search(
+                                               removed.begin(), removed.end(),
+                                               fact);
+                                       }),
+                        facts.end());
+        };
+        // If the same fact is added and deleted by an operator the STRIPS
+        // formalism adds it.
+        remove(op.del_effects, op.add_effects);
+        // If a fact is present in the precondition, we do not have to add it.
+        remove(op.add_effects, op.preconditions);
+        return true;
+    }
+
+    /*
+    Intern the instances in "buffer", each an action followed by the
+    objects of its parameters, and append the operators of the new ones
+    to "operators". "added" is called with every atom that an operator
+    adds.
+    */
+    template <typename Added>
+    void create_operators(const std::vector<int>& buffer,
+                          std::vector<_GroundOperator>& operators,
+                          Added&& added) {
+        for (size_t i = 0; i < buffer.size();) {
+            int a = buffer[i];
+            int arity = (int)actions[a].types.size();
+            auto [instance, inserted] =
+                instances.insert(a, buffer.data() + i + 1, arity);
+            i += 1 + arity;
+            if (!inserted) {
+                continue;
+            }
+            _GroundOperator op;
+            if (!create_operator(instance, op)) {
+                continue;
+            }
+            for (int fact : op.add_effects) {
+                added(fact);
+            }
+            operators.push_back(std::move(op));
+        }
+    }
+};
+
+inline std::string _Grounding::operator_name(int instance) const {
+    const _LiftedAction& action = actions[instances.symbol(instance)];
+    std::string name = "(" + symbols.actions.name(action.symbol);
+    if (instances.arity(instance) > 0) {
+        name += " ";
+        for (int i = 0; i < instances.arity(instance); i++) {
+            name += symbols.objects.name(instances.args(instance)[i]) + " ";
+        }
+    }
+    return name + ")";
+}
+
+inline std::vector<_GroundOperator> _Grounding::ground_actions(
+    unsigned num_threads) {
+    /*
+    Ground all actions and return the resulting list of operators. The
+    assignments of every action are enumerated in parallel, each into its
+    own buffer, and the operators are created in the order of the actions.
+    @param num_threads: Number of threads, 0 for one per hardware thread
+    */
+    std::vector<std::vector<int>> buffers(actions.size());
+    ThreadPool pool(num_threads);
+    pool.parallel_for((int)actions.size(), [&](int a, unsigned) {
+        // Join the parameter domains with the static preconditions
+        _AssignmentEnumerator assignments(
+            parameter_domains(actions[a]),
+            join_conditions(actions[a],
+                            [&](int predicate) {
+                                return static_predicate(predicate);
+                            }),
+            *init_index);
+        std::vector<int> values(assignments.num_parameters());
+        assignments.for_each(values, [&](const std::vector<int>& objects) {
+            buffers[a].push_back(a);
+            buffers[a].insert(buffers[a].end(), objects.begin(),
+                              objects.end());
+        });
+    });
+    std::vector<_GroundOperator> operators;
+    for (const std::vector<int>& buffer : buffers) {
+        create_operators(buffer, operators, [](int) {});
+    }
+    return operators;
+}
+
+inline std::vector<_GroundOperator> _Grounding::ground_reachable_actions(
+    unsigned num_threads) {
+    /*
+    Ground the operators that are reachable in the delete relaxation of the
+    task, and only those. This is the least fixpoint of the Datalog program
+    with one rule per action, "the add effects of an action hold if all of
+    its preconditions hold", from the facts of the initial state.
+
+    The fixpoint is evaluated semi-naively: every round only derives the
+    operators that have a precondition among the atoms reached in the
+    previous round (the delta); such an operator is found by binding that
+    precondition to a delta atom and joining the other preconditions with
+    all reached atoms. Operators without preconditions are grounded in the
+    first round.
+
+    Within a round, the bindings of every precondition to chunks of the
+    delta are independent work items, which run in parallel and write the
+    instances that were not grounded before the round to their own
+    buffers; only the buffers are merged, in the order of the items, into
+    the instances and atoms. So the operators and their order do not
+    depend on the number of threads.
+    @param num_threads: Number of threads, 0 for one per hardware thread
+    */
+    const int chunk_size = 64;
+    AtomIndex reached(atoms, initial_state);
+    auto any_predicate = [](int) { return true; };
+
+    // one enumerator per precondition of every action, which binds the
+    // precondition to a delta atom and joins the others with "reached"
+    struct Seed {
+        int action;
+        _LiftedAtom condition;
+        std::unique_ptr<_AssignmentEnumerator> assignments;
+    };
+    std::vector<Seed> seeds;
+    std::vector<std::unique_ptr<_AssignmentEnumerator>> unconditional(
+        actions.size());
+    for (int a = 0; a < (int)actions.size(); a++) {
+        std::vector<std::vector<int>> domains = parameter_domains(actions[a]);
+        std::vector<_LiftedAtom> conditions =
+            join_conditions(actions[a], any_predicate);
+        if (conditions.empty()) {
+            unconditional[a] = std::make_unique<_AssignmentEnumerator>(
+                domains, conditions, reached);
+        }
+        for (int i = 0; i < (int)conditions.size(); i++) {
+            std::vector<int> prebound;
+            for (int param : conditions[i].params) {
+                if (param >= 0) {
+                    prebound.push_back(param);
+                }
+            }
+            std::sort(prebound.begin(), prebound.end());
+            prebound.erase(std::unique(prebound.begin(), prebound.end()),
+                           prebound.end());
+            std::vector<_LiftedAtom> others = conditions;
+            others.erase(others.begin() + i);
+            seeds.push_back(
+                {a, conditions[i],
+                 std::make_unique<_AssignmentEnumerator>(domains, others,
+                                                         reached, prebound)});
         }
-        Operator* op = _create_operator(&action, tmp_dict, statics_set, init);
-        if (op != nullptr) {
-            operators.push_back(*op);
+    }
+
+    // per thread the partial assignments of the enumerations
+    ThreadPool pool(num_threads);
+    std::vector<std::vector<int>> values(pool.size());
+
+    // the instances of a work item that were not grounded before the round
+    auto ground_new = [&](int a, const _AssignmentEnumerator& enumerator,
+                          unsigned thread, std::vector<int>& buffer) {
+        enumerator.for_each(
+            values[thread], [&](const std::vector<int>& objects) {
+                if (instances.find(a, objects) >= 0) {
+                    return;
+                }
+                buffer.push_back(a);
+                buffer.insert(buffer.end(), objects.begin(), objects.end());
+            });
+    };
+
+    struct WorkItem {
+        int seed;  // or -1 - the action of an unconditional enumerator
+        int begin;
+        int end;  // of the delta atoms to bind the seed to
+    };
+    std::vector<WorkItem> items;
+    for (int a = 0; a < (int)actions.size(); a++) {
+        if (unconditional[a]) {
+            items.push_back({-1 - a, 0, 0});
         }
     }
 
+    std::vector<_GroundOperator> operators;
+    AtomIndex delta(atoms, initial_state);
+    while (true) {
+        for (int s = 0; s < (int)seeds.size(); s++) {
+            int num_delta =
+                (int)delta.atoms(seeds[s].condition.predicate).size();
+            for (int begin = 0; begin < num_delta; begin += chunk_size) {
+                items.push_back(
+                    {s, begin, std::min(begin + chunk_size, num_delta)});
+            }
+        }
+
+        std::vector<std::vector<int>> buffers(items.size());
+        pool.parallel_for((int)items.size(), [&](int i, unsigned thread) {
+            const WorkItem& item = items[i];
+            std::vector<int>& objects = values[thread];
+            if (item.seed < 0) {
+                int a = -1 - item.seed;
+                objects.assign(unconditional[a]->num_parameters(), -1);
+                ground_new(a, *unconditional[a], thread, buffers[i]);
+                return;
+            }
+            const Seed& seed = seeds[item.seed];
+            const _LiftedAtom& condition = seed.condition;
+            const std::vector<int>& delta_atoms =
+                delta.atoms(condition.predicate);
+            for (int t = item.begin; t < item.end; t++) {
+                int atom = delta_atoms[t];
+                if (atoms.arity(atom) != (int)condition.params.size()) {
+                    continue;
+                }
+                const int* tuple = atoms.args(atom);
+                // bind the parameters of the precondition to the delta atom;
+                // a parameter that occurs twice needs the same object
+                objects.assign(seed.assignments->num_parameters(), -1);
+                bool matches = true;
+                for (int j = 0; matches && j < atoms.arity(atom); j++) {
+                    int param = condition.params[j];
+                    if (param < 0) {
+                        matches = tuple[j] == condition.constants[j];
+                    } else if (objects[param] >= 0) {
+                        matches = tuple[j] == objects[param];
+                    } else {
+                        matches = seed.assignments->in_domain(param, tuple[j]);
+                        objects[param] = tuple[j];
+                    }
+                }
+                if (matches) {
+                    ground_new(seed.action, *seed.assignments, thread,
+                               buffers[i]);
+                }
+            }
+        });
+        items.clear();
+
+        // merge the buffers in order; the atoms first reached in this round
+        // are the next delta
+        delta = AtomIndex(atoms);
+        for (const std::vector<int>& buffer : buffers) {
+            create_operators(buffer, operators, [&](int fact) {
+                if (reached.insert(fact)) {
+                    delta.insert(fact);
+                }
+            });
+        }
+        if (delta.empty()) {
+            break;
+        }
+    }
     return operators;
 }
 
 inline std::vector<Operator> _ground_actions(
     std::vector<Action>& actions,
-    std::unordered_map<std::string, std::vector<std::string>> type_map,
-    std::vector<string> statics, flat_hash_set<std::string> init) {
+    const std::unordered_map<std::string, std::vector<std::string>>& type_map,
+    const std::vector<string>& statics,
+    const flat_hash_set<std::string>& init, unsigned num_threads = 0) {
     /*
     Ground a list of actions and return the resulting list of operators.
     @param actions: List of actions
     @param type_map: Mapping from type to objects of that type
     @param statics: Names of the static predicates
     @param init: Grounded initial state
+    @param num_threads: Number of threads, 0 for one per hardware thread
     */
-    std::vector<std::vector<Operator>> op_lists;
-    for (Action action : actions) {
-        op_lists.push_back(_ground_action(action, type_map, statics, init));
-    }
-    std::vector<Operator> operators;
-    for (std::vector<Operator> op_list : op_lists) {
-        for (Operator op : op_list) {
-            operators.push_back(op);
-        }
-    }
-    return operators;
+    _Grounding grounding(actions, type_map, statics, init);
+    return grounding.to_operators(grounding.ground_actions(num_threads));
+}
+
+inline std::vector<Operator> _ground_action(
+    Action& action,
+    const std::unordered_map<std::string, std::vector<std::string>>& type_map,
+    const std::vector<std::string>& statics,
+    const flat_hash_set<std::string>& init) {
+    std::vector<Action> actions = {action};
+    return _ground_actions(actions, type_map, statics, init, 1);
+}
+
+inline std::vector<Operator> _ground_reachable_actions(
+    std::vector<Action>& actions,
+    const std::unordered_map<std::string, std::vector<std::string>>& type_map,
+    const std::vector<string>& statics,
+    const flat_hash_set<std::string>& init, unsigned num_threads = 0) {
+    /*
+    Ground the operators of a list of actions that are reachable in the
+    delete relaxation of the task, see _Grounding.
+    @param actions: List of actions
+    @param type_map: Mapping from type to objects of that type
+    @param statics: Names of the static predicates
+    @param init: Grounded initial state
+    @param num_threads: Number of threads, 0 for one per hardware thread
+    */
+    _Grounding grounding(actions, type_map, statics, init);
+    return grounding.to_operators(
+        grounding.ground_reachable_actions(num_threads));
 }
 
 inline Task ground(Problem& problem,
                    bool remove_statics_from_initial_state = true,
-                   bool remove_irrelevant_operators = true) {
+                   bool remove_irrelevant_operators = true,
+                   bool synthesize_variables = true,
+                   bool relaxed_reachability = true,
+                   unsigned num_threads = 0) {
     // Objects
-    // std::unordered_map<std::string, Type>* objects = &(problem.objects);
     for (auto& constant : problem.domain->constants) {
         problem.objects.insert({constant.first, constant.second});
     }
 
-    // std::vector<Action> domain_actions = problem.domain->actions;
     if (problem.domain->actions.size() == 0) {
         for (auto ap : problem.domain->actions_dict) {
             problem.domain->actions.push_back(ap.second);
         }
     }
 
-    // problem.domain.actions = domain_actions;
-    // std::vector<Predicate> domain_predicates = problem.domain->predicates;
     if (problem.domain->predicates.size() == 0) {
         for (auto pp : problem.domain->predicates_dict) {
             problem.domain->predicates.push_back(pp.second);
         }
     }
 
-    std::unordered_map<std::string, std::vector<std::string>> type_map =
-        _create_type_map(problem.objects);
-    // Get the names of the static predicates
-    std::vector<std::string> statics =
-        _get_statics(problem.domain->predicates, problem.domain->actions);
-
-    // Create a map from types to objects
-    // std::unordered_map<Type, std::vector<std::string>> type_map =
-    //    _create_type_map(problem.objects);
-
-    // Transform initial state into a specific state
-    flat_hash_set<string> init = _get_partial_state(problem.init);
+    // Intern the names of the types, objects, predicates and actions; from
+    // here on atoms and operators are ids, and names are only built for
+    // output
+    _Grounding grounding(
+        problem.domain->actions, _create_type_map(problem.objects),
+        _get_statics(problem.domain->predicates, problem.domain->actions),
+        problem.init);
 
-    //  Ground actions
-    std::vector<Operator> operators =
-        _ground_actions(problem.domain->actions, type_map, statics, init);
+    //  Ground actions, only the reachable ones unless disabled
+    std::vector<_GroundOperator> operators =
+        relaxed_reachability
+            ? grounding.ground_reachable_actions(num_threads)
+            : grounding.ground_actions(num_threads);
 
     // Ground goal
     // TODO: Remove facts that can only become true and are true in the
     //       initial state
     // TODO: Return simple unsolvable problem if goal contains a fact that can
     //       only become false and is false in the initial state
-    flat_hash_set<std::string> goals = _get_partial_state(problem.goal);
+    std::vector<int> goals;
+    for (const Predicate& atom : problem.goal) {
+        goals.push_back(grounding.intern_atom(atom));
+    }
 
     // Collect facts from operators and include the ones from the goal
-    flat_hash_set<std::string> facts = _collect_facts(operators);
-    facts.insert(goals.begin(), goals.end());
-
-    // Remove statics from initial state
-    flat_hash_set<std::string> new_init;
-    if (remove_statics_from_initial_state) {
-        for (std::string i : init) {
-            if (facts.count(i) > 0) {
-                new_init.insert(i);
+    int num_atoms = grounding.atoms.size();
+    std::vector<char> is_fact(num_atoms, 0);
+    for (const _GroundOperator& op : operators) {
+        for (const std::vector<int>* facts :
+             {&op.preconditions, &op.add_effects, &op.del_effects}) {
+            for (int fact : *facts) {
+                is_fact[fact] = 1;
             }
         }
-        init = new_init;
     }
-
-    // Perform relevance analysis
-    if (remove_irrelevant_operators) {
-        operators = relevance_analysis(operators, goals);
+    for (int goal : goals) {
+        is_fact[goal] = 1;
     }
 
-    int i = 0;
-    std::unordered_map<std::string, int> encoding_map;
-    std::unordered_map<int, std::string> reverse_encoding_map;
-    for (std::string s : facts) {
-        encoding_map.insert({s, i});
-        reverse_encoding_map.insert({i, s});
-        i++;
+    // Remove statics from initial state
+    std::vector<int> init;
+    for (int atom : grounding.initial_state) {
+        if (!remove_statics_from_initial_state || is_fact[atom]) {
+            init.push_back(atom);
+        }
     }
 
-    std::unordered_map<int, std::string> action_id2name;
-    for (Operator& op : operators) {
-        encoding_map.insert({op.name, i});
-        reverse_encoding_map.insert({i, op.name});
-        action_id2name.insert({i, op.name});
-        i++;
+    // Perform relevance analysis
+    if (remove_irrelevant_operators) {
+        operators = relevance_analysis(operators, goals, num_atoms);
     }
 
+    // The facts are numbered in the order of their atoms, then the atoms of
+    // the initial state that are no facts, and the operators after them
+    GroundAtomTable fact_atoms;
+    std::vector<int> fact_of(num_atoms, -1);
+    auto number = [&](int atom) {
+        if (fact_of[atom] < 0) {
+            fact_of[atom] =
+                fact_atoms
+                    .insert(grounding.atoms.symbol(atom),
+                            grounding.atoms.args(atom),
+                            grounding.atoms.arity(atom))
+                    .first;
+        }
+        return fact_of[atom];
+    };
     flat_hash_set<int> encoded_facts;
     flat_hash_set<int> encoded_init;
     flat_hash_set<int> encoded_goals;
-    std::vector<EncodedOperator> encoded_operators;
-
-    for (std::string s : facts) {
-        encoded_facts.emplace(encoding_map[s]);
+    for (int atom = 0; atom < num_atoms; atom++) {
+        if (is_fact[atom]) {
+            encoded_facts.insert(number(atom));
+        }
     }
-    for (std::string s : init) {
-        encoded_init.emplace(encoding_map[s]);
+    for (int atom : init) {
+        encoded_init.insert(number(atom));
     }
-    for (std::string s : goals) {
-        encoded_goals.emplace(encoding_map[s]);
+    for (int goal : goals) {
+        encoded_goals.insert(number(goal));
     }
-    for (Operator& op : operators) {
-        encoded_operators.push_back(EncodedOperator(op, encoding_map));
+
+    int first_operator_name = fact_atoms.size();
+    OperatorTable encoded_operators;
+    GroundAtomTable operator_atoms;
+    auto encode = [&](const std::vector<int>& atoms) {
+        std::vector<int> facts;
+        for (int atom : atoms) {
+            facts.push_back(fact_of[atom]);
+        }
+        return facts;
+    };
+    for (const _GroundOperator& op : operators) {
+        const _LiftedAction& action =
+            grounding.actions[grounding.instances.symbol(op.instance)];
+        int name = first_operator_name +
+                   operator_atoms
+                       .insert(action.symbol,
+                               grounding.instances.args(op.instance),
+                               grounding.instances.arity(op.instance))
+                       .first;
+        encoded_operators.add_operator(name, encode(op.preconditions),
+                                       encode(op.add_effects),
+                                       encode(op.del_effects));
     }
 
     Task task(problem.name, encoded_facts, encoded_init, encoded_goals,
-              encoded_operators);
-    task.encoding_map = encoding_map;
-    task.action_id2name = action_id2name;
+              std::move(encoded_operators));
+    task.symbols = std::move(grounding.symbols);
+    task.fact_atoms = std::move(fact_atoms);
+    task.operator_atoms = std::move(operator_atoms);
+    task.first_operator_name = first_operator_name;
+
+    // Group mutually exclusive facts into finite-domain variables
+    if (synthesize_variables) {
+        task.variables =
+            compute_variable_layout(task, synthesize_mutex_groups(task));
+    }
     return task;
 }
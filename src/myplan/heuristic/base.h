@@ -4,15 +4,44 @@
 #include "../task.h"
 
 struct Heuristic {
-    virtual float calculate_h(int this_id, std::vector<SearchNode> &nodes) = 0;
+    virtual ~Heuristic() = default;
+
+    // Called by a search before its first evaluation, e.g. to register the
+    // per-state tables the heuristic needs in "space"
+    virtual void initialize(SearchSpace &space) {}
+
+    virtual float calculate_h(const PackedState &state, StateID id,
+                              SearchSpace &space) = 0;
+
+    /*
+    Like calculate_h, but the heuristic may stop as soon as it knows that
+    h > bound. It then sets "exact" to false and returns a lower bound on
+    h that is greater than "bound".
+    */
+    virtual float calculate_h_bounded(const PackedState &state, StateID id,
+                                      SearchSpace &space, float bound,
+                                      bool &exact) {
+        exact = true;
+        return calculate_h(state, id, space);
+    }
+
+    /*
+    Preferred (helpful) operators of the last evaluated state, as operator
+    names. Only heuristics that support them fill the list, and only if
+    compute_preferred_operators is set.
+    */
+    virtual bool supports_preferred_operators() const { return false; }
+    bool compute_preferred_operators = false;
+    std::vector<int> preferred_operators;
 };
 
 struct BlindHeuristic : Heuristic {
     Task task;
     BlindHeuristic(Task &task_) { task = task_; }
 
-    float calculate_h(int this_id, std::vector<SearchNode> &nodes) {
-        if (task.goal_reached(nodes[this_id].state)) {
+    float calculate_h(const PackedState &state, StateID id,
+                      SearchSpace &space) {
+        if (task.goal_reached(state)) {
             return 1.0;
         } else {
             return 0.0;
@@ -24,10 +53,11 @@ struct GoalCountHeuristic : Heuristic {
     Task task;
     GoalCountHeuristic(Task &task_) { task = task_; }
 
-    float calculate_h(int this_id, std::vector<SearchNode> &nodes) {
+    float calculate_h(const PackedState &state, StateID id,
+                      SearchSpace &space) {
         int cnt_unsatisfied_cond = 0;
         for (int g : task.goals) {
-            if (nodes[this_id].state.find(g) == nodes[this_id].state.end()) {
+            if (!state.test(g)) {
                 cnt_unsatisfied_cond++;
             }
         }
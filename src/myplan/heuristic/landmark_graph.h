@@ -0,0 +1,232 @@
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+#include "../operator_table.h"
+#include "../search/searchspace.h"
+#include "../task.h"
+
+struct LandmarkGraph {
+    /*
+    Fact landmarks of a task and the orderings between them. Every landmark
+    is a node with a dense id; "facts[node]" is its fact and "node_of" maps
+    a fact back to its node.
+
+    An ordering "parent -> child" is greedy-necessary: the parent holds
+    whenever the child is achieved for the first time, because it is a
+    precondition of all operators that can achieve the child first.
+    */
+    std::vector<int> facts;
+    flat_hash_map<int, int> node_of;
+    std::vector<char> is_goal;
+    std::vector<std::vector<int>> parents;
+    std::vector<std::vector<int>> children;
+    // operators (table indices) that can achieve the landmark first
+    std::vector<std::vector<int>> first_achievers;
+
+    int size() const { return (int)facts.size(); }
+
+    bool contains(int fact) const { return node_of.count(fact) > 0; }
+
+    int add_node(int fact, bool goal) {
+        auto it = node_of.find(fact);
+        if (it != node_of.end()) {
+            is_goal[it->second] = is_goal[it->second] || goal;
+            return it->second;
+        }
+        int node = size();
+        facts.push_back(fact);
+        node_of[fact] = node;
+        is_goal.push_back(goal);
+        parents.emplace_back();
+        children.emplace_back();
+        first_achievers.emplace_back();
+        return node;
+    }
+
+    void add_ordering(int parent, int child) {
+        parents[child].push_back(parent);
+        children[parent].push_back(child);
+    }
+};
+
+/*
+Compute the causal fact landmarks of the delete relaxation in one pass over
+the relaxed planning graph (Zhu and Givan, 2003).
+
+Every reached fact carries a label: the sorted set of facts that every
+relaxed plan reaching it achieves, itself included. The label of an
+operator is the union of the labels of its preconditions, and a fact's
+label is the intersection over its achievers of their labels plus their
+add effects, so facts that are only achieved as side effects of a
+necessary operator are landmarks too.
+Labels start at the first achiever and only shrink, so a worklist over the
+facts whose label changed reaches the fixpoint.
+
+The landmarks are the goals and the facts in the labels of the goals that
+do not hold initially. An achiever of a landmark can apply first if the
+landmark is not in its own label; the preconditions shared by all such
+achievers are ordered before the landmark.
+*/
+inline LandmarkGraph compute_landmark_graph(Task& task) {
+    const OperatorTable& operators = task.operators;
+    int num_facts = task.num_state_words * STATE_WORD_BITS;
+    int num_ops = operators.size();
+    std::vector<std::vector<int>> precondition_of(num_facts);
+    std::vector<int> no_precondition_ops;
+    std::vector<int> unsatisfied(num_ops);
+    for (int op = 0; op < num_ops; op++) {
+        for (int fact : operators.preconditions(op)) {
+            precondition_of[fact].push_back(op);
+        }
+        unsatisfied[op] = operators.preconditions(op).size();
+        if (unsatisfied[op] == 0) {
+            no_precondition_ops.push_back(op);
+        }
+    }
+
+    std::vector<char> reached(num_facts, 0);
+    std::vector<std::vector<int>> label(num_facts);
+    std::vector<int> open;
+    std::vector<char> in_open(num_facts, 0);
+    for (int fact : task.initial_state) {
+        reached[fact] = 1;
+        label[fact] = {fact};
+        open.push_back(fact);
+        in_open[fact] = 1;
+    }
+
+    std::vector<int> op_label;
+    std::vector<int> merged;
+    auto compute_op_label = [&](int op) {
+        op_label.clear();
+        for (int pre : operators.preconditions(op)) {
+            merged.clear();
+            std::set_union(op_label.begin(), op_label.end(),
+                           label[pre].begin(), label[pre].end(),
+                           std::back_inserter(merged));
+            op_label.swap(merged);
+        }
+    };
+    // the facts that every relaxed plan applying "op" has achieved
+    std::vector<int> achieved;
+    auto apply = [&](int op) {
+        compute_op_label(op);
+        FactRange adds = operators.add_effects(op);
+        achieved.clear();
+        std::set_union(op_label.begin(), op_label.end(), adds.begin(),
+                       adds.end(), std::back_inserter(achieved));
+        for (int eff : adds) {
+            if (!reached[eff]) {
+                reached[eff] = 1;
+                label[eff] = achieved;
+            } else {
+                merged.clear();
+                std::set_intersection(label[eff].begin(), label[eff].end(),
+                                      achieved.begin(), achieved.end(),
+                                      std::back_inserter(merged));
+                if (merged.size() == label[eff].size()) {
+                    continue;
+                }
+                label[eff].swap(merged);
+            }
+            if (!in_open[eff]) {
+                in_open[eff] = 1;
+                open.push_back(eff);
+            }
+        }
+    };
+
+    for (int op : no_precondition_ops) {
+        apply(op);
+    }
+    // every fact is expanded once when it is reached and again whenever its
+    // label shrinks; the operators are fired once all their preconditions
+    // have been reached
+    std::vector<char> expanded(num_facts, 0);
+    while (!open.empty()) {
+        int fact = open.back();
+        open.pop_back();
+        in_open[fact] = 0;
+        bool first = !expanded[fact];
+        expanded[fact] = 1;
+        for (int op : precondition_of[fact]) {
+            if (first) {
+                unsatisfied[op]--;
+            }
+            if (unsatisfied[op] == 0) {
+                apply(op);
+            }
+        }
+    }
+
+    LandmarkGraph graph;
+    std::vector<int> goals(task.goals.begin(), task.goals.end());
+    std::sort(goals.begin(), goals.end());
+    for (int goal : goals) {
+        graph.add_node(goal, true);
+    }
+    for (int goal : goals) {
+        if (!reached[goal]) {
+            // unsolvable in the relaxation, only the goals are reported
+            return graph;
+        }
+    }
+    for (int goal : goals) {
+        for (int fact : label[goal]) {
+            if (task.initial_state.count(fact) == 0) {
+                graph.add_node(fact, false);
+            }
+        }
+    }
+
+    std::vector<std::vector<int>> achievers(graph.size());
+    for (int op = 0; op < num_ops; op++) {
+        if (unsatisfied[op] > 0) {
+            continue;  // never applicable in the relaxation
+        }
+        for (int eff : operators.add_effects(op)) {
+            auto it = graph.node_of.find(eff);
+            if (it != graph.node_of.end()) {
+                achievers[it->second].push_back(op);
+            }
+        }
+    }
+
+    std::vector<int> shared;
+    for (int node = 0; node < graph.size(); node++) {
+        int fact = graph.facts[node];
+        if (task.initial_state.count(fact) > 0) {
+            continue;
+        }
+        bool first = true;
+        for (int op : achievers[node]) {
+            compute_op_label(op);
+            if (std::binary_search(op_label.begin(), op_label.end(), fact)) {
+                continue;
+            }
+            graph.first_achievers[node].push_back(op);
+            FactRange pre = operators.preconditions(op);
+            if (first) {
+                shared.assign(pre.begin(), pre.end());
+                first = false;
+            } else {
+                merged.clear();
+                std::set_intersection(shared.begin(), shared.end(),
+                                      pre.begin(), pre.end(),
+                                      std::back_inserter(merged));
+                shared.swap(merged);
+            }
+        }
+        for (int parent : shared) {
+            auto it = graph.node_of.find(parent);
+            if (it != graph.node_of.end()) {
+                graph.add_ordering(it->second, node);
+            }
+        }
+        shared.clear();
+    }
+    return graph;
+}
@@ -1,79 +1,38 @@
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <vector>
+
 #include "../search/searchspace.h"
 #include "../task.h"
+#include "../simplex.h"
 #include "base.h"
+#include "landmark_graph.h"
 #include "limits"
 
 const float FLOAT_INF = std::numeric_limits<float>::max();
 
-template <typename T>
-bool is_subset(const flat_hash_set<T>& set1, const flat_hash_set<T>& set2) {
-    for (const T& elem : set1) {
-        if (set2.find(elem) == set2.end()) {
-            return false;
-        }
-    }
-    return true;
-}
-
 Task _get_relaxed_task(Task task) {
     Task relaxed_task = task;
-    for (EncodedOperator& op : relaxed_task.operators) {
-        op.del_effects = {};
-    }
+    relaxed_task.operators = task.operators.relaxed();
     return relaxed_task;
 }
 
-flat_hash_set<int> get_landmarks(Task& task_) {
-    Task task = _get_relaxed_task(task_);
-    flat_hash_set<int> landmarks(task.goals.begin(), task.goals.end());
-    flat_hash_set<int> possible_landmarks(task.facts.begin(), task.facts.end());
-    for (int s : task.goals) {
-        if (possible_landmarks.count(s) > 0) {
-            possible_landmarks.erase(s);
-        }
-    }
-
-    for (int fact : possible_landmarks) {
-        flat_hash_set<int> current_state(task.initial_state.begin(),
-                                         task.initial_state.end());
-        bool goal_reached = is_subset(task.goals, current_state);
-
-        while (!goal_reached) {
-            flat_hash_set<int> previous_state(current_state.begin(),
-                                              current_state.end());
-
-            for (EncodedOperator op : task.operators) {
-                if (op.applicable(current_state) &&
-                    (op.add_effects.find(fact) == op.add_effects.end())) {
-                    current_state = op.apply(current_state, 0).second;
-                    if (is_subset(task.goals, current_state)) {
-                        break;
-                    }
-                }
-            }
-
-            if ((previous_state == current_state) &&
-                !(is_subset(task.goals, current_state))) {
-                landmarks.insert(fact);
-                break;
-            }
-
-            goal_reached = is_subset(task.goals, current_state);
-        }
-    }
-
-    return landmarks;
+// The landmark facts of "task", see compute_landmark_graph()
+flat_hash_set<int> get_landmarks(Task& task) {
+    LandmarkGraph graph = compute_landmark_graph(task);
+    return flat_hash_set<int>(graph.facts.begin(), graph.facts.end());
 }
 
 flat_hash_map<int, float> compute_landmark_costs(
     Task& task, flat_hash_set<int>& landmarks) {
     flat_hash_map<int, flat_hash_set<int>> op_to_lm;
-    for (EncodedOperator& op : task.operators) {
-        for (int landmark : landmarks) {
-            if (op.add_effects.find(landmark) != op.add_effects.end()) {
-                op_to_lm[op.name].emplace(landmark);
+    for (int op = 0; op < task.operators.size(); op++) {
+        for (int add : task.operators.add_effects(op)) {
+            if (landmarks.find(add) != landmarks.end()) {
+                op_to_lm[task.operators.names[op]].emplace(add);
             }
         }
     }
@@ -94,49 +53,187 @@ flat_hash_map<int, float> compute_landmark_costs(
 }
 
 struct LandmarkHeuristic : Heuristic {
+    /*
+    The landmark-count heuristic. Every state stores the landmarks it has
+    accepted as a bitset over the nodes of the landmark graph. A landmark is
+    accepted in the initial state if it holds there, and otherwise when the
+    operator that reached the state adds it while all its parents in the
+    graph are accepted by the parent state. Accepted goals that do not hold
+    are required again.
+
+    Landmarks with the same cost share a mask, so h is the sum of the cost
+    times the popcount of the needed landmarks in each mask.
+    */
     Task task;
+    LandmarkGraph graph;
     flat_hash_set<int> landmarks;
     flat_hash_map<int, float> costs;
+    std::vector<int> landmark_of;      // per fact, the node or -1
+    flat_hash_map<int, int> op_index;  // operator name -> table index
+    std::vector<int> goal_nodes;
+    std::vector<float> class_costs;
+    std::vector<std::vector<uint64_t>> class_masks;
+    int num_words = 0;
+    PerStateBitset* accepted_table = nullptr;
+    std::vector<uint64_t> needed;
+
     LandmarkHeuristic(Task& task_) {
         task = task_;
-        landmarks = get_landmarks(task);
+        graph = compute_landmark_graph(task);
+        landmarks.insert(graph.facts.begin(), graph.facts.end());
         costs = compute_landmark_costs(task, landmarks);
+
+        num_words = get_num_state_words(graph.size());
+        landmark_of.assign(task.num_state_words * STATE_WORD_BITS, -1);
+        for (int node = 0; node < graph.size(); node++) {
+            landmark_of[graph.facts[node]] = node;
+            if (graph.is_goal[node]) {
+                goal_nodes.push_back(node);
+            }
+            auto it = costs.find(graph.facts[node]);
+            if (it == costs.end() || it->second == 0) {
+                continue;
+            }
+            int c = std::find(class_costs.begin(), class_costs.end(),
+                              it->second) -
+                    class_costs.begin();
+            if (c == (int)class_costs.size()) {
+                class_costs.push_back(it->second);
+                class_masks.emplace_back(num_words, 0);
+            }
+            class_masks[c][node / 64] |= uint64_t(1) << (node % 64);
+        }
+        for (int op = 0; op < task.operators.size(); op++) {
+            op_index[task.operators.names[op]] = op;
+        }
+        needed.assign(num_words, 0);
+    }
+
+    void initialize(SearchSpace& space) {
+        accepted_table = &space.register_bitset(graph.size());
     }
 
-    float calculate_h(int this_id, std::vector<SearchNode>& nodes) {
-        if (nodes[this_id].parent_id == -1) {
-            nodes[this_id].unreached = landmarks;
-            for (int s : task.initial_state) {
-                // if (nodes[this_id].unreached.count(s) > 0) {
-                nodes[this_id].unreached.erase(s);
-                //}
+    float calculate_h(const PackedState& state, StateID id,
+                      SearchSpace& space) {
+        compute_needed(state, id, space);
+        float h = 0;
+        for (size_t c = 0; c < class_costs.size(); c++) {
+            int count = 0;
+            for (int w = 0; w < num_words; w++) {
+                count += __builtin_popcountll(needed[w] & class_masks[c][w]);
             }
-        } else {
-            nodes[this_id].unreached =
-                nodes[nodes[this_id].parent_id].unreached;
-            // if (nodes[this_id].unreached.count(nodes[this_id].action) > 0) {
-            nodes[this_id].unreached.erase(nodes[this_id].action);
-            //}
+            h += class_costs[c] * count;
         }
+        return h;
+    }
 
-        flat_hash_set<int> unreached(nodes[this_id].unreached.begin(),
-                                     nodes[this_id].unreached.end());
-        for (int s : task.goals) {
-            if (unreached.count(s) == 0) {
-                unreached.emplace(s);
+    // Accept the landmarks of the state "id" and collect the needed ones
+    void compute_needed(const PackedState& state, StateID id,
+                        SearchSpace& space) {
+        assert(accepted_table);
+        const SearchNodeInfo& info = space[id];
+        uint64_t* accepted = (*accepted_table)[id];
+        if (info.parent_id == NO_STATE) {
+            std::fill(accepted, accepted + num_words, 0);
+            for (int node = 0; node < graph.size(); node++) {
+                if (state.test(graph.facts[node])) {
+                    accepted[node / 64] |= uint64_t(1) << (node % 64);
+                }
             }
+        } else {
+            const uint64_t* parent = (*accepted_table)[info.parent_id];
+            std::copy(parent, parent + num_words, accepted);
+            int op = op_index[info.action];
+            for (int fact : task.operators.add_effects(op)) {
+                int node = landmark_of[fact];
+                if (node >= 0 && !test(parent, node) &&
+                    std::all_of(graph.parents[node].begin(),
+                                graph.parents[node].end(),
+                                [&](int p) { return test(parent, p); })) {
+                    accepted[node / 64] |= uint64_t(1) << (node % 64);
+                }
+            }
+        }
+
+        for (int w = 0; w < num_words; w++) {
+            needed[w] = ~accepted[w];
         }
-        for (int s : nodes[this_id].state) {
-            // if (unreached.count(s) > 0) {
-            unreached.erase(s);
-            //}
+        for (int node : goal_nodes) {
+            if (!state.test(graph.facts[node])) {
+                needed[node / 64] |= uint64_t(1) << (node % 64);
+            }
         }
+    }
 
-        float h = 0;
-        for (int landmark : unreached) {
-            h += costs[landmark];
+    static bool test(const uint64_t* bits, int node) {
+        return (bits[node / 64] >> (node % 64)) & 1;
+    }
+};
+
+struct OptimalLandmarkHeuristic : LandmarkHeuristic {
+    /*
+    The landmark-count heuristic with an optimal cost partitioning
+    (Karpas and Domshlak, 2009): the costs of the needed landmarks are the
+    solution of
+
+        maximize sum_l c_l  subject to
+        sum_{l added by o} c_l <= cost(o) for every operator o,  c_l >= 0.
+
+    The constraints do not depend on the state; the landmarks that are not
+    needed simply get the objective coefficient 0. Every evaluation is
+    therefore warm-started from the optimal basis of the previous one.
+    Operators that add the same set of landmarks share the row of the
+    cheapest of them, and operators that add no landmark have no row.
+    */
+    SimplexSolver solver;
+    std::vector<double> objective;
+
+    OptimalLandmarkHeuristic(Task& task_) : LandmarkHeuristic(task_) {
+        int num_cols = graph.size();
+        std::map<std::vector<int>, int> row_of;
+        std::vector<std::vector<int>> rows;
+        std::vector<double> bounds;
+        std::vector<int> row;
+        for (int op = 0; op < task.operators.size(); op++) {
+            row.clear();
+            for (int fact : task.operators.add_effects(op)) {
+                if (landmark_of[fact] >= 0) {
+                    row.push_back(landmark_of[fact]);
+                }
+            }
+            if (row.empty()) {
+                continue;
+            }
+            std::sort(row.begin(), row.end());
+            auto [it, inserted] = row_of.emplace(row, (int)rows.size());
+            if (inserted) {
+                rows.push_back(row);
+                bounds.push_back(task.operators.costs[op]);
+            } else {
+                bounds[it->second] = std::min(
+                    bounds[it->second], (double)task.operators.costs[op]);
+            }
         }
+        std::vector<double> matrix(rows.size() * num_cols, 0);
+        for (size_t i = 0; i < rows.size(); i++) {
+            for (int node : rows[i]) {
+                matrix[i * num_cols + node] = 1;
+            }
+        }
+        solver = SimplexSolver(num_cols, std::move(matrix), std::move(bounds));
+        objective.assign(num_cols, 0);
+    }
 
-        return h;
+    float calculate_h(const PackedState& state, StateID id,
+                      SearchSpace& space) {
+        compute_needed(state, id, space);
+        for (int node = 0; node < graph.size(); node++) {
+            objective[node] = test(needed.data(), node) ? 1 : 0;
+        }
+        if (solver.solve(objective) == LPStatus::UNBOUNDED) {
+            // a needed landmark has no achiever
+            return std::numeric_limits<float>::max();
+        }
+        return (float)solver.objective_value();
     }
 };
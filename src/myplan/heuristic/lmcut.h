@@ -0,0 +1,277 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "../search/searchspace.h"
+#include "../task.h"
+#include "relaxation.h"
+
+struct LmCutHeuristic : _RelaxationHeuristic {
+    /*
+    The LM-cut heuristic (Helmert and Domshlak, 2009).
+
+    Every round computes h_max with the current operator costs, finds a
+    cut of operators that separates the state from the goal zone (the
+    facts that reach the most expensive goal through zero-cost h_max
+    supporters), adds the cheapest cost of the cut to h and subtracts it
+    from all operators of the cut. After the first round h_max is not
+    recomputed from scratch: lowering the cost of the cut operators can
+    only lower distances, which are propagated incrementally from them.
+
+    It reuses the h_max arrays, CSR indices and queue of the relaxation
+    core; the cost of the artificial goal operator is 0, so the goal zone
+    is grown from the goal with the largest h_max value.
+    */
+    std::vector<int> cost;            // per operator, reduced by the cuts
+    std::vector<int> supporter;       // per operator, -1 if it has no pre
+    std::vector<int> supporter_cost;  // per operator, h_max of its supporter
+    // operators that add fact f are achievers[achiever_offsets[f] .. ]
+    std::vector<int> achiever_offsets;
+    std::vector<int> achievers;
+
+    std::vector<char> in_goal_zone;  // per fact
+    std::vector<char> reached;       // per fact
+    std::vector<char> in_cut;        // per operator
+    std::vector<int> marked_facts;
+    std::vector<int> cut;
+    std::vector<int> stack;
+
+    LmCutHeuristic(Task& task)
+        : _RelaxationHeuristic(task, CostCombination::MAX) {
+        int num_facts = (int)distance.size();
+        int num_ops = operators.size();
+        achiever_offsets.assign(num_facts + 1, 0);
+        for (int fact : operators.add_facts) {
+            achiever_offsets[fact + 1]++;
+        }
+        for (int f = 0; f < num_facts; f++) {
+            achiever_offsets[f + 1] += achiever_offsets[f];
+        }
+        achievers.resize(operators.add_facts.size());
+        std::vector<int> pos(achiever_offsets.begin(),
+                             achiever_offsets.end() - 1);
+        for (int op = 0; op < num_ops; op++) {
+            for (int fact : operators.add_effects(op)) {
+                achievers[pos[fact]++] = op;
+            }
+        }
+
+        cost.assign(num_ops, 0);
+        supporter.assign(num_ops, -1);
+        supporter_cost.assign(num_ops, 0);
+        in_goal_zone.assign(num_facts, 0);
+        reached.assign(num_facts, 0);
+        in_cut.assign(num_ops, 0);
+    }
+
+    bool supports_preferred_operators() const { return false; }
+
+    float calculate_h(const PackedState& state, StateID id,
+                      SearchSpace& space) {
+        cost = operators.costs;
+        first_exploration(state);
+
+        int h = 0;
+        int goal = goal_supporter();
+        if (goal >= 0 && distance[goal] == RELAXED_INF) {
+            return std::numeric_limits<float>::max();
+        }
+        while (goal >= 0 && distance[goal] > 0) {
+            mark_goal_zone(goal);
+            find_cut(state);
+            int cut_cost = RELAXED_INF;
+            for (int op : cut) {
+                cut_cost = std::min(cut_cost, cost[op]);
+            }
+            assert(cut_cost > 0);
+            h += cut_cost;
+            for (int op : cut) {
+                cost[op] -= cut_cost;
+            }
+            incremental_exploration();
+            reset_marks();
+            goal = goal_supporter();
+        }
+        return (float)h;
+    }
+
+    // The goal with the largest h_max value, -1 if there are no goals
+    int goal_supporter() const {
+        int best = -1;
+        for (int fact : goals) {
+            if (best < 0 || distance[fact] > distance[best]) {
+                best = fact;
+            }
+        }
+        return best;
+    }
+
+    void first_exploration(const PackedState& state) {
+        std::fill(distance.begin(), distance.end(), RELAXED_INF);
+        for (int op = 0; op < operators.size(); op++) {
+            unsatisfied[op] = operators.pre_offsets[op + 1] -
+                              operators.pre_offsets[op];
+        }
+        queue.clear();
+        for (int fact : state) {
+            distance[fact] = 0;
+            queue.push(0, fact);
+        }
+        for (int op : no_precondition_ops) {
+            supporter[op] = -1;
+            supporter_cost[op] = 0;
+            reach_effects(op, cost[op]);
+        }
+        while (!queue.empty()) {
+            auto [dist, fact] = queue.pop();
+            if (dist > distance[fact]) {
+                continue;
+            }
+            int begin = precondition_of_offsets[fact];
+            int end = precondition_of_offsets[fact + 1];
+            for (int i = begin; i < end; i++) {
+                int op = precondition_of[i];
+                if (--unsatisfied[op] == 0) {
+                    // the last settled precondition has the largest h_max
+                    supporter[op] = fact;
+                    supporter_cost[op] = dist;
+                    reach_effects(op, add_cost(dist, cost[op]));
+                }
+            }
+        }
+    }
+
+    void incremental_exploration() {
+        /*
+        Propagate the cheaper costs of the cut operators. Only operators
+        whose supporter became cheaper can become cheaper themselves, and
+        their new supporter is found by rescanning the preconditions.
+        */
+        queue.clear();
+        for (int op : cut) {
+            reach_effects(op, add_cost(supporter_cost[op], cost[op]));
+        }
+        while (!queue.empty()) {
+            auto [dist, fact] = queue.pop();
+            if (dist > distance[fact]) {
+                continue;
+            }
+            int begin = precondition_of_offsets[fact];
+            int end = precondition_of_offsets[fact + 1];
+            for (int i = begin; i < end; i++) {
+                int op = precondition_of[i];
+                if (supporter[op] != fact || supporter_cost[op] <= dist) {
+                    continue;
+                }
+                int old_cost = supporter_cost[op];
+                update_supporter(op);
+                if (supporter_cost[op] < old_cost) {
+                    reach_effects(op, add_cost(supporter_cost[op], cost[op]));
+                }
+            }
+        }
+    }
+
+    void update_supporter(int op) {
+        for (int pre : operators.preconditions(op)) {
+            if (pre == supporter[op] || distance[pre] > distance[supporter[op]]) {
+                supporter[op] = pre;
+            }
+        }
+        supporter_cost[op] = distance[supporter[op]];
+    }
+
+    void reach_effects(int op, int dist) {
+        for (int eff : operators.add_effects(op)) {
+            if (dist < distance[eff]) {
+                distance[eff] = dist;
+                queue.push(dist, eff);
+            }
+        }
+    }
+
+    void mark_goal_zone(int goal) {
+        // facts that reach "goal" through zero-cost h_max supporters
+        stack.assign(1, goal);
+        in_goal_zone[goal] = 1;
+        marked_facts.push_back(goal);
+        while (!stack.empty()) {
+            int fact = stack.back();
+            stack.pop_back();
+            int begin = achiever_offsets[fact];
+            int end = achiever_offsets[fact + 1];
+            for (int i = begin; i < end; i++) {
+                int op = achievers[i];
+                int supp = supporter[op];
+                if (cost[op] == 0 && unsatisfied[op] == 0 && supp >= 0 &&
+                    !in_goal_zone[supp]) {
+                    in_goal_zone[supp] = 1;
+                    marked_facts.push_back(supp);
+                    stack.push_back(supp);
+                }
+            }
+        }
+    }
+
+    void find_cut(const PackedState& state) {
+        /*
+        Walk forward from the state along h_max supporters without entering
+        the goal zone. The operators that would enter it form the cut.
+        */
+        cut.clear();
+        stack.clear();
+        for (int fact : state) {
+            reached[fact] = 1;
+            marked_facts.push_back(fact);
+            stack.push_back(fact);
+        }
+        for (int op : no_precondition_ops) {
+            visit_operator(op);
+        }
+        while (!stack.empty()) {
+            int fact = stack.back();
+            stack.pop_back();
+            int begin = precondition_of_offsets[fact];
+            int end = precondition_of_offsets[fact + 1];
+            for (int i = begin; i < end; i++) {
+                int op = precondition_of[i];
+                if (supporter[op] == fact && unsatisfied[op] == 0) {
+                    visit_operator(op);
+                }
+            }
+        }
+    }
+
+    void visit_operator(int op) {
+        if (in_cut[op]) {
+            return;
+        }
+        for (int eff : operators.add_effects(op)) {
+            if (in_goal_zone[eff]) {
+                in_cut[op] = 1;
+                cut.push_back(op);
+                return;
+            }
+        }
+        for (int eff : operators.add_effects(op)) {
+            if (!reached[eff]) {
+                reached[eff] = 1;
+                marked_facts.push_back(eff);
+                stack.push_back(eff);
+            }
+        }
+    }
+
+    void reset_marks() {
+        for (int fact : marked_facts) {
+            in_goal_zone[fact] = 0;
+            reached[fact] = 0;
+        }
+        marked_facts.clear();
+        for (int op : cut) {
+            in_cut[op] = 0;
+        }
+    }
+};
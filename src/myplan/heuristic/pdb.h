@@ -0,0 +1,340 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <tuple>
+#include <vector>
+
+#include "../operator_table.h"
+#include "../search/searchspace.h"
+#include "../task.h"
+#include "base.h"
+
+const uint8_t PDB_INF = 255;
+
+class PatternDatabase {
+    /*
+    The goal distances of the projection of a task onto a pattern, a small
+    set of facts.
+
+    Facts are binary, so an abstract state is the bitmask of the pattern
+    facts that hold and its index in the table is that bitmask: the perfect
+    hash of a state is the sum of 2^i over the i-th pattern facts that are
+    true. The projection of an operator keeps the parts of its
+    preconditions and effects that are in the pattern; operators without
+    an effect on the pattern are self-loops and are dropped.
+
+    The distances are computed by a backward uniform-cost search from all
+    abstract goal states that regresses the projected operators, and are
+    stored as one byte per abstract state. Distances above PDB_INF - 1 are
+    stored as PDB_INF - 1, which only lowers them; PDB_INF marks the states
+    from which the abstract goal is unreachable.
+    */
+   public:
+    PatternDatabase(const OperatorTable& operators,
+                    const std::vector<int>& goals, std::vector<int> facts)
+        : pattern(std::move(facts)) {
+        std::sort(pattern.begin(), pattern.end());
+        assert(pattern.size() < 32);
+        int num_states = 1 << pattern.size();
+        project_operators(operators);
+
+        uint32_t goal_mask = mask_of(goals.begin(), goals.end());
+        std::vector<int> distance(num_states, std::numeric_limits<int>::max());
+        // buckets[d] holds the states first reached with distance d
+        std::vector<std::vector<uint32_t>> buckets(1);
+        for (int s = 0; s < num_states; s++) {
+            if ((s & goal_mask) == goal_mask) {
+                distance[s] = 0;
+                buckets[0].push_back(s);
+            }
+        }
+        for (size_t d = 0; d < buckets.size(); d++) {
+            for (size_t i = 0; i < buckets[d].size(); i++) {
+                uint32_t s = buckets[d][i];
+                if (distance[s] != (int)d) {
+                    continue;  // reached again with a smaller distance
+                }
+                for (const AbstractOperator& op : abstract_operators) {
+                    regress(op, s, (int)d, distance, buckets);
+                }
+            }
+        }
+
+        distances.resize(num_states);
+        for (int s = 0; s < num_states; s++) {
+            distances[s] = distance[s] == std::numeric_limits<int>::max()
+                               ? PDB_INF
+                               : (uint8_t)std::min(distance[s], PDB_INF - 1);
+        }
+    }
+
+    // The abstract goal distance of "state", PDB_INF if there is none
+    int lookup(const PackedState& state) const {
+        uint32_t index = 0;
+        for (size_t i = 0; i < pattern.size(); i++) {
+            index |= (uint32_t)state.test(pattern[i]) << i;
+        }
+        return distances[index];
+    }
+
+    const std::vector<int>& get_pattern() const { return pattern; }
+    int size() const { return (int)distances.size(); }
+
+   private:
+    struct AbstractOperator {
+        uint32_t pre;
+        uint32_t add;
+        uint32_t del;  // without the facts that are also added
+        int cost;
+    };
+
+    std::vector<int> pattern;
+    std::vector<uint8_t> distances;
+    std::vector<AbstractOperator> abstract_operators;
+
+    template <typename It>
+    uint32_t mask_of(It first, It last) const {
+        uint32_t mask = 0;
+        for (; first != last; ++first) {
+            auto it = std::lower_bound(pattern.begin(), pattern.end(), *first);
+            if (it != pattern.end() && *it == *first) {
+                mask |= uint32_t(1) << (it - pattern.begin());
+            }
+        }
+        return mask;
+    }
+
+    void project_operators(const OperatorTable& operators) {
+        // operators with the same projection are merged into the cheapest
+        std::map<std::tuple<uint32_t, uint32_t, uint32_t>, int> cost_of;
+        for (int op = 0; op < operators.size(); op++) {
+            FactRange pre = operators.preconditions(op);
+            FactRange add = operators.add_effects(op);
+            FactRange del = operators.del_effects(op);
+            uint32_t add_mask = mask_of(add.begin(), add.end());
+            uint32_t del_mask = mask_of(del.begin(), del.end()) & ~add_mask;
+            if (add_mask == 0 && del_mask == 0) {
+                continue;
+            }
+            auto key = std::make_tuple(mask_of(pre.begin(), pre.end()),
+                                       add_mask, del_mask);
+            auto it = cost_of.find(key);
+            if (it == cost_of.end()) {
+                cost_of[key] = operators.costs[op];
+            } else {
+                it->second = std::min(it->second, operators.costs[op]);
+            }
+        }
+        for (auto& [key, cost] : cost_of) {
+            abstract_operators.push_back(
+                {std::get<0>(key), std::get<1>(key), std::get<2>(key), cost});
+        }
+    }
+
+    /*
+    Reach the predecessors of "s" under "op". A predecessor agrees with "s"
+    on the facts that "op" does not change and satisfies the precondition;
+    the changed facts that are not preconditions may have either value.
+    */
+    void regress(const AbstractOperator& op, uint32_t s, int d,
+                 std::vector<int>& distance,
+                 std::vector<std::vector<uint32_t>>& buckets) {
+        uint32_t effect = op.add | op.del;
+        if ((s & op.add) != op.add || (s & op.del) != 0 ||
+            (s & op.pre & ~effect) != (op.pre & ~effect)) {
+            return;
+        }
+        uint32_t base = (s & ~effect) | (op.pre & effect);
+        uint32_t free = effect & ~op.pre;
+        int pred_d = d + op.cost;
+        uint32_t sub = 0;
+        while (true) {
+            uint32_t pred = base | sub;
+            if (pred_d < distance[pred]) {
+                distance[pred] = pred_d;
+                if ((int)buckets.size() <= pred_d) {
+                    buckets.resize(pred_d + 1);
+                }
+                buckets[pred_d].push_back(pred);
+            }
+            if (sub == free) {
+                break;
+            }
+            sub = (sub - free) & free;  // next subset of "free"
+        }
+    }
+};
+
+/*
+Select one pattern per goal: the goal and the facts it causally depends
+on, i.e. the preconditions of the achievers of the pattern facts, added in
+breadth-first order until the pattern has "max_pattern_size" facts.
+Duplicate patterns are removed.
+*/
+inline std::vector<std::vector<int>> select_goal_patterns(
+    Task& task, int max_pattern_size) {
+    const OperatorTable& operators = task.operators;
+    int num_facts = task.num_state_words * STATE_WORD_BITS;
+    std::vector<std::vector<int>> achievers(num_facts);
+    for (int op = 0; op < operators.size(); op++) {
+        for (int fact : operators.add_effects(op)) {
+            achievers[fact].push_back(op);
+        }
+    }
+
+    std::vector<int> goals(task.goals.begin(), task.goals.end());
+    std::sort(goals.begin(), goals.end());
+    std::vector<std::vector<int>> patterns;
+    std::vector<char> in_pattern(num_facts, 0);
+    for (int goal : goals) {
+        std::vector<int> pattern = {goal};
+        in_pattern[goal] = 1;
+        for (size_t i = 0; i < pattern.size() &&
+                           (int)pattern.size() < max_pattern_size;
+             i++) {
+            for (int op : achievers[pattern[i]]) {
+                for (int pre : operators.preconditions(op)) {
+                    if (!in_pattern[pre] &&
+                        (int)pattern.size() < max_pattern_size) {
+                        in_pattern[pre] = 1;
+                        pattern.push_back(pre);
+                    }
+                }
+            }
+        }
+        for (int fact : pattern) {
+            in_pattern[fact] = 0;
+        }
+        std::sort(pattern.begin(), pattern.end());
+        if (std::find(patterns.begin(), patterns.end(), pattern) ==
+            patterns.end()) {
+            patterns.push_back(pattern);
+        }
+    }
+    return patterns;
+}
+
+/*
+The maximal sets of pairwise additive patterns. Two patterns are additive
+if no operator has effects on both, so that no operator is counted by both
+projections.
+*/
+inline std::vector<std::vector<int>> compute_additive_cliques(
+    const OperatorTable& operators,
+    const std::vector<std::vector<int>>& patterns) {
+    int n = (int)patterns.size();
+    std::vector<std::vector<char>> additive(n, std::vector<char>(n, 1));
+    std::vector<int> touched;
+    for (int op = 0; op < operators.size(); op++) {
+        touched.clear();
+        for (int p = 0; p < n; p++) {
+            auto in_pattern = [&](int fact) {
+                return std::binary_search(patterns[p].begin(),
+                                          patterns[p].end(), fact);
+            };
+            FactRange add = operators.add_effects(op);
+            FactRange del = operators.del_effects(op);
+            if (std::any_of(add.begin(), add.end(), in_pattern) ||
+                std::any_of(del.begin(), del.end(), in_pattern)) {
+                touched.push_back(p);
+            }
+        }
+        for (int p : touched) {
+            for (int q : touched) {
+                if (p != q) {
+                    additive[p][q] = 0;
+                }
+            }
+        }
+    }
+
+    // Bron-Kerbosch without pivoting
+    std::vector<std::vector<int>> cliques;
+    std::vector<int> clique;
+    auto expand = [&](auto& self, std::vector<int> candidates,
+                      std::vector<int> excluded) -> void {
+        if (candidates.empty() && excluded.empty()) {
+            cliques.push_back(clique);
+            return;
+        }
+        while (!candidates.empty()) {
+            int p = candidates.back();
+            std::vector<int> next_candidates, next_excluded;
+            for (int q : candidates) {
+                if (q != p && additive[p][q]) {
+                    next_candidates.push_back(q);
+                }
+            }
+            for (int q : excluded) {
+                if (additive[p][q]) {
+                    next_excluded.push_back(q);
+                }
+            }
+            clique.push_back(p);
+            self(self, next_candidates, next_excluded);
+            clique.pop_back();
+            candidates.pop_back();
+            excluded.push_back(p);
+        }
+    };
+    std::vector<int> all(n);
+    for (int p = 0; p < n; p++) {
+        all[p] = p;
+    }
+    expand(expand, all, {});
+    for (std::vector<int>& c : cliques) {
+        std::sort(c.begin(), c.end());
+    }
+    return cliques;
+}
+
+struct PDBHeuristic : Heuristic {
+    /*
+    The canonical heuristic of a collection of pattern databases: the
+    maximum over the maximal additive subsets of the sum of their values.
+    An evaluation is one table lookup per pattern and the sums over the
+    cliques, so it costs O(sum of the pattern sizes + cliques).
+    */
+    std::vector<PatternDatabase> pdbs;
+    std::vector<std::vector<int>> cliques;
+    std::vector<int> values;
+
+    PDBHeuristic(Task& task, int max_pattern_size = 12)
+        : PDBHeuristic(task, select_goal_patterns(task, max_pattern_size)) {}
+
+    PDBHeuristic(Task& task, const std::vector<std::vector<int>>& patterns) {
+        std::vector<int> goals(task.goals.begin(), task.goals.end());
+        for (const std::vector<int>& pattern : patterns) {
+            pdbs.emplace_back(task.operators, goals, pattern);
+        }
+        std::vector<std::vector<int>> sorted_patterns;
+        for (const PatternDatabase& pdb : pdbs) {
+            sorted_patterns.push_back(pdb.get_pattern());
+        }
+        cliques = compute_additive_cliques(task.operators, sorted_patterns);
+        values.resize(pdbs.size());
+    }
+
+    float calculate_h(const PackedState& state, StateID id,
+                      SearchSpace& space) {
+        for (size_t i = 0; i < pdbs.size(); i++) {
+            values[i] = pdbs[i].lookup(state);
+            if (values[i] == PDB_INF) {
+                return std::numeric_limits<float>::max();
+            }
+        }
+        int h = 0;
+        for (const std::vector<int>& clique : cliques) {
+            int sum = 0;
+            for (int i : clique) {
+                sum += values[i];
+            }
+            h = std::max(h, sum);
+        }
+        return (float)h;
+    }
+};
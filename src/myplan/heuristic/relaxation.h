@@ -1,220 +1,355 @@
 #pragma once
 
-#include <queue>
-#include <set>
-#include <string>
-#include <tuple>
-#include <unordered_set>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
 
+#include "../operator_table.h"
 #include "../search/searchspace.h"
 #include "../task.h"
 #include "base.h"
-#include "limits"
-
-struct RelaxedOperator {
-    int name;
-    std::vector<int> preconditions;
-    std::vector<int> add_effects;
-    int cost;
-    int counter;
-
-    RelaxedOperator(int name, std::vector<int>& preconditions,
-                    std::vector<int>& add_effects)
-        : name(name),
-          preconditions(preconditions),
-          add_effects(add_effects),
-          cost(1),
-          counter(preconditions.size()) {}
-};
 
-struct RelaxedFact {
-    int name;
-    std::vector<int> precondition_of;
-    bool expanded;
-    float distance;
-
-    RelaxedFact() {}
-    RelaxedFact(int name)
-        : name(name),
-          expanded(false),
-          distance(std::numeric_limits<float>::max()) {}
-};
+const int RELAXED_INF = std::numeric_limits<int>::max();
 
-struct _RelaxationHeuristic : Heuristic {
-    flat_hash_map<int, RelaxedFact> facts;
-    std::vector<RelaxedOperator> operators;
-    flat_hash_set<int> init;
-    flat_hash_set<int> goals;
-    int tie_breaker;
-    RelaxedFact start_state;
-
-    _RelaxationHeuristic(Task& task)
-        : tie_breaker(0),
-          goals(task.goals),
-          init(task.initial_state),
-          start_state(RelaxedFact(-1)) {
-        facts.emplace(-1, start_state);
-        for (int fact : task.facts) {
-            facts.emplace(fact, RelaxedFact(fact));
-        }
-
-        for (EncodedOperator& op : task.operators) {
-            operators.emplace_back(RelaxedOperator(
-                op.name, op.preconditions_vec, op.add_effects_vec));
-
-            for (int var : op.preconditions_vec) {
-                facts[var].precondition_of.emplace_back(operators.size() - 1);
-            }
+class RelaxedQueue {
+    /*
+    A monotone priority queue of (distance, fact) pairs for Dijkstra's
+    algorithm over integer distances. Distances below "num_buckets" are
+    kept in FIFO buckets (Dial's algorithm), so with unit costs every push
+    and pop is O(1); larger distances, which only h_add can produce, overflow
+    into a binary heap. The memory is kept between evaluations.
+    */
+   public:
+    RelaxedQueue(int num_buckets = 1 << 12) : buckets(num_buckets) {}
+
+    void push(int distance, int fact) {
+        if (distance < (int)buckets.size()) {
+            assert(distance >= current);
+            buckets[distance].push_back(fact);
+            bucket_entries++;
+        } else {
+            heap.emplace_back(-distance, fact);
+            std::push_heap(heap.begin(), heap.end());
+        }
+    }
 
-            if (op.preconditions_vec.size() == 0) {
-                start_state.precondition_of.emplace_back(operators.size() - 1);
+    // Remove the entry with the smallest distance
+    std::pair<int, int> pop() {
+        assert(!empty());
+        if (bucket_entries > 0) {
+            while (head == buckets[current].size()) {
+                buckets[current].clear();
+                head = 0;
+                current++;
             }
+            bucket_entries--;
+            return std::make_pair(current, buckets[current][head++]);
+        }
+        std::pop_heap(heap.begin(), heap.end());
+        std::pair<int, int> top = heap.back();
+        heap.pop_back();
+        return std::make_pair(-top.first, top.second);
+    }
+
+    bool empty() const { return bucket_entries == 0 && heap.empty(); }
+
+    void clear() {
+        bucket_entries += head;
+        for (int d = current; bucket_entries > 0; d++) {
+            bucket_entries -= buckets[d].size();
+            buckets[d].clear();
         }
+        heap.clear();
+        current = 0;
+        head = 0;
     }
 
-    virtual float eval(std::vector<float>& distances) = 0;
+   private:
+    std::vector<std::vector<int>> buckets;
+    std::vector<std::pair<int, int>> heap;  // (-distance, fact)
+    int bucket_entries = 0;
+    int current = 0;
+    size_t head = 0;  // entries of the current bucket are popped in order
+};
 
-    float calculate_h(int this_id, std::vector<SearchNode>& nodes) {
-        init_distance(nodes[this_id].state);
+enum class CostCombination { SUM, MAX };
 
-        std::priority_queue<tuple<float, int, int>> queue;
-        queue.push({0, -tie_breaker, start_state.name});
-        tie_breaker++;
+struct _RelaxationHeuristic : Heuristic {
+    /*
+    Cost propagation in the delete relaxation over flat arrays indexed by
+    the dense fact and operator ids.
 
-        for (int fact : nodes[this_id].state) {
-            queue.push({-facts[fact].distance, -tie_breaker, facts[fact].name});
-            tie_breaker++;
+    Every operator keeps the number of its preconditions that are not
+    reached yet and the sum (h_add) or maximum (h_max) of the distances of
+    the reached ones, so it is evaluated in O(1) when its last precondition
+    is popped. All arrays and the queue are allocated once and reset in
+    place at the start of every evaluation.
+    */
+    CostCombination combination;
+    OperatorTable operators;
+    std::vector<int> goals;
+    // operators that have fact f as a precondition are
+    // precondition_of[precondition_of_offsets[f] .. [f + 1] - 1]
+    std::vector<int> precondition_of_offsets;
+    std::vector<int> precondition_of;
+    std::vector<int> no_precondition_ops;
+
+    std::vector<char> is_goal;        // per fact
+    int num_unsettled_goals = 0;      // goals whose distance is not final
+    std::vector<int> distance;        // per fact
+    std::vector<int> best_supporter;  // per fact, -1 if none
+    std::vector<int> unsatisfied;     // per operator
+    std::vector<int> op_cost;         // per operator, combined pre distance
+    RelaxedQueue queue;
+
+    // scratch space of extract_relaxed_plan()
+    std::vector<char> fact_marked;
+    std::vector<char> op_marked;
+    std::vector<int> marked;
+    std::vector<int> open_facts;
+
+    _RelaxationHeuristic(Task& task, CostCombination combination)
+        : combination(combination),
+          operators(task.operators),
+          goals(task.goals.begin(), task.goals.end()) {
+        std::sort(goals.begin(), goals.end());
+        int num_facts = task.num_state_words * STATE_WORD_BITS;
+        int num_ops = operators.size();
+
+        precondition_of_offsets.assign(num_facts + 1, 0);
+        for (int fact : operators.pre_facts) {
+            precondition_of_offsets[fact + 1]++;
+        }
+        for (int f = 0; f < num_facts; f++) {
+            precondition_of_offsets[f + 1] += precondition_of_offsets[f];
+        }
+        precondition_of.resize(operators.pre_facts.size());
+        std::vector<int> pos(precondition_of_offsets.begin(),
+                             precondition_of_offsets.end() - 1);
+        for (int op = 0; op < num_ops; op++) {
+            for (int fact : operators.preconditions(op)) {
+                precondition_of[pos[fact]++] = op;
+            }
+            if (operators.preconditions(op).empty()) {
+                no_precondition_ops.push_back(op);
+            }
         }
 
-        dijkstra(queue);
-        float h = calc_goal_h();
+        is_goal.assign(num_facts, 0);
+        for (int fact : goals) {
+            is_goal[fact] = 1;
+        }
+        distance.assign(num_facts, RELAXED_INF);
+        best_supporter.assign(num_facts, -1);
+        unsatisfied.assign(num_ops, 0);
+        op_cost.assign(num_ops, 0);
+        fact_marked.assign(num_facts, 0);
+        op_marked.assign(num_ops, 0);
+    }
+
+    float calculate_h(const PackedState& state, StateID id,
+                      SearchSpace& space) {
+        float h = compute_distances(state);
+        if (compute_preferred_operators) {
+            extract_relaxed_plan(state);
+        }
         return h;
     }
 
-    void reset_fact(RelaxedFact& fact, const flat_hash_set<int>& state) {
-        fact.expanded = false;
-        if (state.find(fact.name) != state.end()) {
-            fact.distance = 0;
-        } else {
-            fact.distance = std::numeric_limits<float>::max();
+    /*
+    Compute the distances from "state" and return the value of the goals.
+    The exploration stops as soon as the last goal is settled, so only the
+    facts closer than the farthest goal are guaranteed to have their final
+    distance.
+
+    If the exploration reaches a distance greater than "bound" before all
+    goals are settled, it stops there as well, "exact" is set to false and
+    that distance is returned. It is a lower bound on h_max only.
+    */
+    float compute_distances(const PackedState& state,
+                            int bound = RELAXED_INF) {
+        bool exact;
+        return compute_distances(state, bound, exact);
+    }
+
+    float compute_distances(const PackedState& state, int bound,
+                            bool& exact) {
+        init_distance(state);
+        for (int op : no_precondition_ops) {
+            fire(op);
+        }
+        int stopped_at = dijkstra(bound);
+        exact = stopped_at == RELAXED_INF;
+        if (!exact) {
+            return (float)stopped_at;
         }
+        return calc_goal_h();
     }
 
-    void init_distance(const flat_hash_set<int>& state) {
-        reset_fact(start_state, state);
+    bool supports_preferred_operators() const { return true; }
 
-        for (auto& item : facts) {
-            reset_fact(item.second, state);
+    float extract_relaxed_plan(const PackedState& state) {
+        /*
+        Trace the relaxed plan back from the goals along the best
+        supporters and return its cost. The operators of the relaxed plan
+        that are applicable in "state" are the preferred operators.
+        */
+        float cost = 0;
+        preferred_operators.clear();
+        open_facts.assign(goals.begin(), goals.end());
+        while (!open_facts.empty()) {
+            int fact = open_facts.back();
+            open_facts.pop_back();
+            if (fact_marked[fact]) {
+                continue;
+            }
+            fact_marked[fact] = 1;
+            marked.push_back(fact);
+            int supporter = best_supporter[fact];
+            if (supporter < 0 || op_marked[supporter]) {
+                continue;
+            }
+            op_marked[supporter] = 1;
+            marked.push_back(-1 - supporter);
+            cost += operators.costs[supporter];
+            bool applicable = true;
+            for (int pre : operators.preconditions(supporter)) {
+                applicable = applicable && state.test(pre);
+                open_facts.push_back(pre);
+            }
+            if (applicable && compute_preferred_operators) {
+                preferred_operators.push_back(operators.names[supporter]);
+            }
         }
+        for (int m : marked) {
+            if (m >= 0) {
+                fact_marked[m] = 0;
+            } else {
+                op_marked[-1 - m] = 0;
+            }
+        }
+        marked.clear();
+        return cost;
+    }
 
-        for (RelaxedOperator& op : operators) {
-            op.counter = op.preconditions.size();
+    void init_distance(const PackedState& state) {
+        std::fill(distance.begin(), distance.end(), RELAXED_INF);
+        std::fill(best_supporter.begin(), best_supporter.end(), -1);
+        std::fill(op_cost.begin(), op_cost.end(), 0);
+        for (int op = 0; op < operators.size(); op++) {
+            unsatisfied[op] = operators.pre_offsets[op + 1] -
+                              operators.pre_offsets[op];
+        }
+        queue.clear();
+        num_unsettled_goals = (int)goals.size();
+        for (int fact : state) {
+            distance[fact] = 0;
+            queue.push(0, fact);
         }
     }
 
-    float get_cost(RelaxedOperator& op, RelaxedFact& pre) {
-        float cost = 0;
-        if (op.preconditions.size() != 0) {
-            std::vector<float> tmp_distances;
-            tmp_distances.reserve(op.preconditions.size());
-            for (int pre : op.preconditions) {
-                tmp_distances.emplace_back(facts[pre].distance);
+    // Reach the add effects of "op", whose preconditions are all reached
+    void fire(int op) {
+        int dist = add_cost(op_cost[op], operators.costs[op]);
+        for (int eff : operators.add_effects(op)) {
+            if (dist < distance[eff]) {
+                distance[eff] = dist;
+                best_supporter[eff] = op;
+                queue.push(dist, eff);
             }
-            cost = eval(tmp_distances);
-        } else {
-            cost = 0;
         }
-        return cost + op.cost;
     }
 
-    float calc_goal_h() {
-        if (goals.size() != 0) {
-            std::vector<float> tmp_distances;
-            tmp_distances.reserve(goals.size());
-            for (int fact : goals) {
-                tmp_distances.emplace_back(facts[fact].distance);
+    // Settle facts until all goals are settled. Returns the distance at
+    // which the exploration passed "bound", RELAXED_INF if it did not.
+    int dijkstra(int bound) {
+        while (num_unsettled_goals > 0 && !queue.empty()) {
+            auto [dist, fact] = queue.pop();
+            if (dist > distance[fact]) {
+                continue;  // outdated entry
             }
-            return eval(tmp_distances);
-        } else {
-            return 0.0;
-        }
-    }
-
-    bool finished(flat_hash_set<int>& achived_goals,
-                  std::priority_queue<tuple<float, int, int>>& queue) {
-        // bool flag = true;
-        // for (int i : goals) {
-        //    if (achived_goals.find(i) != achived_goals.end()) {
-        //        flag = false;
-        //        break;
-        //    }
-        // }
-        return (achived_goals == goals) || (queue.empty());
-    }
-
-    void dijkstra(std::priority_queue<tuple<float, int, int>>& queue) {
-        flat_hash_set<int> achived_goals;
-        tuple<float, int, int> front;
-        float _dist, tmp_dist;
-        int _tie, fact_idx, fact_id, num_precondition_of;
-        while (!finished(achived_goals, queue)) {
-            front = queue.top();
-            queue.pop();
-            _dist = -1 * get<0>(front);
-            _tie = -1 * get<1>(front);
-            fact_id = get<2>(front);
-
-            if (goals.find(facts[fact_id].name) != goals.end()) {
-                achived_goals.emplace(facts[fact_id].name);
+            if (dist > bound) {
+                return dist;
             }
-            if (!facts[fact_id].expanded) {
-                num_precondition_of = facts[fact_id].precondition_of.size();
-                for (int i = 0; i < num_precondition_of; i++) {
-                    operators[facts[fact_id].precondition_of[i]].counter--;
-                    if (operators[facts[fact_id].precondition_of[i]].counter <=
-                        0) {
-                        for (int n :
-                             operators[facts[fact_id].precondition_of[i]]
-                                 .add_effects) {
-                            tmp_dist = get_cost(
-                                operators[facts[fact_id].precondition_of[i]],
-                                facts[fact_id]);
-                            if (tmp_dist < facts[n].distance) {
-                                facts[n].distance = tmp_dist;
-                                queue.push({-tmp_dist, -tie_breaker, n});
-                                tie_breaker++;
-                            }
-                        }
-                    }
+            if (is_goal[fact]) {
+                num_unsettled_goals--;
+            }
+            int begin = precondition_of_offsets[fact];
+            int end = precondition_of_offsets[fact + 1];
+            for (int i = begin; i < end; i++) {
+                int op = precondition_of[i];
+                op_cost[op] = combine(op_cost[op], dist);
+                if (--unsatisfied[op] == 0) {
+                    fire(op);
                 }
-                facts[fact_id].expanded = true;
             }
         }
+        return RELAXED_INF;
+    }
+
+    float calc_goal_h() {
+        int h = 0;
+        for (int fact : goals) {
+            if (distance[fact] == RELAXED_INF) {
+                return std::numeric_limits<float>::max();
+            }
+            h = combine(h, distance[fact]);
+        }
+        return (float)h;
+    }
+
+    static int add_cost(int a, int b) {
+        // saturate instead of overflowing on very large h_add values
+        return a >= RELAXED_INF - b ? RELAXED_INF - 1 : a + b;
+    }
+
+    int combine(int acc, int dist) const {
+        if (combination == CostCombination::SUM) {
+            return add_cost(acc, dist);
+        }
+        return std::max(acc, dist);
     }
 };
 
 struct hAddHeuristic : _RelaxationHeuristic {
-    using _RelaxationHeuristic::_RelaxationHeuristic;
+    hAddHeuristic(Task& task)
+        : _RelaxationHeuristic(task, CostCombination::SUM) {}
+};
 
-    float eval(std::vector<float>& distances) {
-        float res = 0;
-        for (float d : distances) {
-            res += d;
+struct hFFHeuristic : hAddHeuristic {
+    /*
+    The FF heuristic: the cost of the relaxed plan that is read off the
+    best supporters of the h_add propagation.
+    */
+    using hAddHeuristic::hAddHeuristic;
+
+    float calculate_h(const PackedState& state, StateID id,
+                      SearchSpace& space) {
+        float h_add = compute_distances(state);
+        if (h_add >= std::numeric_limits<float>::max()) {
+            preferred_operators.clear();
+            return h_add;  // a goal is unreachable
         }
-        return res;
+        return extract_relaxed_plan(state);
     }
 };
 
 struct hMaxHeuristic : _RelaxationHeuristic {
-    using _RelaxationHeuristic::_RelaxationHeuristic;
+    hMaxHeuristic(Task& task)
+        : _RelaxationHeuristic(task, CostCombination::MAX) {}
 
-    float eval(std::vector<float>& distances) {
-        float res = 0;
-        for (float d : distances) {
-            if (d > res) {
-                res = d;
-            }
+    float calculate_h_bounded(const PackedState& state, StateID id,
+                              SearchSpace& space, float bound,
+                              bool& exact) {
+        int int_bound =
+            bound >= (float)RELAXED_INF ? RELAXED_INF : (int)std::floor(bound);
+        float h = compute_distances(state, int_bound, exact);
+        if (exact && compute_preferred_operators) {
+            extract_relaxed_plan(state);
         }
-        return res;
+        return h;
     }
 };
@@ -0,0 +1,323 @@
+#pragma once
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "task.h"
+#include "variables.h"
+
+// A set of facts of which at most one holds in every reachable state
+struct MutexGroup {
+    std::vector<int> facts;
+    bool exactly_one = false;  // one of them always holds
+};
+
+/*
+A candidate invariant: a set of (predicate id, position) pairs. The atoms of
+the listed predicates are grouped by their argument at "position" (all
+atoms of a predicate with position -1 form one group), and the invariant
+claims that at most one atom of every group holds.
+*/
+typedef std::vector<std::pair<int, int>> _InvariantCandidate;
+
+class _MutexGroupSynthesis {
+    /*
+    Invariant synthesis on the grounded task, after Helmert (2009). A
+    candidate is checked against the initial state and every operator:
+
+    - at most one atom of each group holds initially;
+    - an operator adds at most one atom "a" of a group, and if it does, the
+      atom of the group that may hold before is deleted: either its
+      precondition in the group, or, without one, all other atoms of the
+      group.
+
+    If an operator adds "a" without a precondition in the group, the
+    candidate is refined with the predicates of the facts that the
+    operator requires and deletes, and the refinements are checked in
+    turn, e.g. {at(?pkg, *)} grows into {at(?pkg, *), in(?pkg, *)}.
+    */
+   public:
+    _MutexGroupSynthesis(const Task& task)
+        : task(task), atoms(task.fact_atoms) {
+        for (int fact : task.facts) {
+            if (fact < atoms.size()) {
+                facts_of[atoms.symbol(fact)].push_back(fact);
+            }
+        }
+        for (auto& [predicate, facts] : facts_of) {
+            std::sort(facts.begin(), facts.end());
+        }
+    }
+
+    std::vector<MutexGroup> synthesize(int max_candidate_size = 4,
+                                       int max_candidates = 1000) {
+        std::deque<_InvariantCandidate> queue;
+        std::set<_InvariantCandidate> seen;
+        for (auto& [predicate, facts] : facts_of) {
+            // a unary predicate grouped by its argument gives singletons
+            int arity = atoms.arity(facts[0]);
+            for (int pos = -1; pos < (arity > 1 ? arity : 0); pos++) {
+                _InvariantCandidate candidate = {{predicate, pos}};
+                if (seen.insert(candidate).second) {
+                    queue.push_back(candidate);
+                }
+            }
+        }
+
+        std::vector<MutexGroup> groups;
+        std::set<std::vector<int>> known;
+        int checked = 0;
+        while (!queue.empty() && checked < max_candidates) {
+            _InvariantCandidate candidate = queue.front();
+            queue.pop_front();
+            checked++;
+            std::vector<_InvariantCandidate> refinements;
+            std::vector<MutexGroup> candidate_groups;
+            if (!check(candidate, candidate_groups, refinements)) {
+                if ((int)candidate.size() < max_candidate_size) {
+                    for (_InvariantCandidate& refined : refinements) {
+                        if (seen.insert(refined).second) {
+                            queue.push_back(refined);
+                        }
+                    }
+                }
+                continue;
+            }
+            for (MutexGroup& group : candidate_groups) {
+                if (group.facts.size() > 1 &&
+                    known.insert(group.facts).second) {
+                    groups.push_back(group);
+                }
+            }
+        }
+        return groups;
+    }
+
+   private:
+    const Task& task;
+    const GroundAtomTable& atoms;  // per fact its predicate and objects
+    std::map<int, std::vector<int>> facts_of;  // per predicate
+
+    bool check(const _InvariantCandidate& candidate,
+               std::vector<MutexGroup>& groups,
+               std::vector<_InvariantCandidate>& refinements) {
+        // the group of every fact and the key object of every group
+        std::unordered_map<int, int> group_of;
+        std::unordered_map<int, int> group_of_key;
+        std::vector<int> keys;  // -1 for all atoms in one group
+        for (auto& [predicate, pos] : candidate) {
+            for (int fact : facts_of[predicate]) {
+                int key = pos < 0 ? -1 : atoms.args(fact)[pos];
+                auto [it, inserted] =
+                    group_of_key.emplace(key, (int)groups.size());
+                if (inserted) {
+                    groups.emplace_back();
+                    keys.push_back(key);
+                }
+                group_of[fact] = it->second;
+                groups[it->second].facts.push_back(fact);
+            }
+        }
+        for (MutexGroup& group : groups) {
+            std::sort(group.facts.begin(), group.facts.end());
+        }
+        auto group = [&](int fact) {
+            auto it = group_of.find(fact);
+            return it == group_of.end() ? -1 : it->second;
+        };
+
+        std::vector<int> initial_count(groups.size(), 0);
+        for (int fact : task.initial_state) {
+            int g = group(fact);
+            if (g >= 0 && ++initial_count[g] > 1) {
+                return false;
+            }
+        }
+        std::vector<char> exactly_one(groups.size());
+        for (size_t g = 0; g < groups.size(); g++) {
+            exactly_one[g] = initial_count[g] == 1;
+        }
+
+        const OperatorTable& operators = task.operators;
+        std::vector<int> touched;
+        for (int op = 0; op < operators.size(); op++) {
+            FactRange pre = operators.preconditions(op);
+            FactRange add = operators.add_effects(op);
+            FactRange del = operators.del_effects(op);
+            touched.clear();
+            for (int fact : add) {
+                if (group(fact) >= 0) {
+                    touched.push_back(group(fact));
+                }
+            }
+            for (int fact : del) {
+                if (group(fact) >= 0) {
+                    touched.push_back(group(fact));
+                }
+            }
+            std::sort(touched.begin(), touched.end());
+            touched.erase(std::unique(touched.begin(), touched.end()),
+                          touched.end());
+            for (int g : touched) {
+                std::vector<int> g_pre, g_add, g_del;
+                for (int fact : pre) {
+                    if (group(fact) == g) g_pre.push_back(fact);
+                }
+                for (int fact : add) {
+                    if (group(fact) == g) g_add.push_back(fact);
+                }
+                for (int fact : del) {
+                    if (group(fact) == g) g_del.push_back(fact);
+                }
+                if (g_pre.size() > 1) {
+                    continue;  // never applicable if the invariant holds
+                }
+                auto deleted = [&](int fact) {
+                    return std::binary_search(g_del.begin(), g_del.end(),
+                                              fact);
+                };
+                if (g_add.empty()) {
+                    // the group may become empty
+                    if (g_pre.empty() || deleted(g_pre[0])) {
+                        exactly_one[g] = 0;
+                    }
+                    continue;
+                }
+                if (g_add.size() > 1) {
+                    return false;
+                }
+                int a = g_add[0];
+                if (!g_pre.empty()) {
+                    if (g_pre[0] == a || deleted(g_pre[0])) {
+                        continue;
+                    }
+                    return false;
+                }
+                bool all_others_deleted = true;
+                for (int fact : groups[g].facts) {
+                    if (fact != a && !deleted(fact)) {
+                        all_others_deleted = false;
+                        break;
+                    }
+                }
+                if (all_others_deleted) {
+                    continue;
+                }
+                propose_refinements(candidate, keys[g], pre, del,
+                                    refinements);
+                return false;
+            }
+        }
+        for (size_t g = 0; g < groups.size(); g++) {
+            groups[g].exactly_one = exactly_one[g];
+        }
+        return true;
+    }
+
+    // Extend "candidate" by a predicate of a fact that "op" needs and deletes
+    void propose_refinements(const _InvariantCandidate& candidate,
+                             int key, FactRange pre,
+                             FactRange del,
+                             std::vector<_InvariantCandidate>& refinements) {
+        bool counted = candidate[0].second < 0;
+        for (int fact : pre) {
+            if (!std::binary_search(del.begin(), del.end(), fact)) {
+                continue;
+            }
+            int predicate = atoms.symbol(fact);
+            bool known = std::any_of(
+                candidate.begin(), candidate.end(),
+                [&](const std::pair<int, int>& member) {
+                    return member.first == predicate;
+                });
+            if (known) {
+                continue;
+            }
+            std::vector<int> positions;
+            if (counted) {
+                positions.push_back(-1);
+            } else {
+                for (int pos = 0; pos < atoms.arity(fact); pos++) {
+                    if (atoms.args(fact)[pos] == key) {
+                        positions.push_back(pos);
+                    }
+                }
+            }
+            for (int pos : positions) {
+                _InvariantCandidate refined = candidate;
+                refined.emplace_back(predicate, pos);
+                std::sort(refined.begin(), refined.end());
+                refinements.push_back(refined);
+            }
+        }
+    }
+};
+
+inline std::vector<MutexGroup> synthesize_mutex_groups(const Task& task) {
+    return _MutexGroupSynthesis(task).synthesize();
+}
+
+/*
+Choose disjoint variables from the mutex groups: the group that covers the
+most facts not covered yet becomes a variable, until no group covers two
+of them. Every remaining fact is a binary variable, and so is every atom of
+the initial state that is no fact, i.e. a static atom that grounding kept. A variable keeps the
+"exactly one" property of its group only if it got all of its facts.
+*/
+inline VariableLayout compute_variable_layout(
+    const Task& task, const std::vector<MutexGroup>& groups) {
+    int num_facts = task.num_state_words * STATE_WORD_BITS;
+    std::vector<char> covered(num_facts, 0);
+    std::vector<std::vector<int>> variables;
+    std::vector<char> exactly_one;
+    std::vector<char> used(groups.size(), 0);
+    while (true) {
+        int best = -1;
+        int best_count = 1;
+        for (size_t g = 0; g < groups.size(); g++) {
+            if (used[g]) {
+                continue;
+            }
+            int count = 0;
+            for (int fact : groups[g].facts) {
+                count += !covered[fact];
+            }
+            if (count > best_count) {
+                best = (int)g;
+                best_count = count;
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+        used[best] = 1;
+        std::vector<int> facts;
+        for (int fact : groups[best].facts) {
+            if (!covered[fact]) {
+                covered[fact] = 1;
+                facts.push_back(fact);
+            }
+        }
+        exactly_one.push_back(groups[best].exactly_one &&
+                              facts.size() == groups[best].facts.size());
+        variables.push_back(facts);
+    }
+    std::vector<int> remaining(task.facts.begin(), task.facts.end());
+    for (int fact : task.initial_state) {
+        if (!task.facts.count(fact)) {
+            remaining.push_back(fact);
+        }
+    }
+    std::sort(remaining.begin(), remaining.end());
+    for (int fact : remaining) {
+        if (!covered[fact]) {
+            variables.push_back({fact});
+            exactly_one.push_back(0);
+        }
+    }
+    return VariableLayout(variables, exactly_one, num_facts);
+}
@@ -0,0 +1,142 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "state.h"
+
+class FactRange {
+    // A read-only view of a contiguous run of fact ids
+   public:
+    FactRange(const int* first, const int* last) : first(first), last(last) {}
+    const int* begin() const { return first; }
+    const int* end() const { return last; }
+    int size() const { return (int)(last - first); }
+    bool empty() const { return first == last; }
+    int operator[](int i) const { return first[i]; }
+
+   private:
+    const int* first;
+    const int* last;
+};
+
+class OperatorTable {
+    /*
+    The operators of a task in compressed-sparse-row layout.
+
+    The preconditions of operator i are pre_facts[pre_offsets[i]] ..
+    pre_facts[pre_offsets[i + 1] - 1], and likewise for the add and delete
+    effects. Every list is sorted by fact id and free of duplicates. Names
+    and costs are stored in one array each, so scanning the operators only
+    touches a handful of flat arrays instead of one heap object per list.
+    Operators are appended once while the task is built and never change
+    afterwards.
+    */
+   public:
+    std::vector<int> names;
+    std::vector<int> costs;
+    std::vector<int> pre_offsets = {0};
+    std::vector<int> pre_facts;
+    std::vector<int> add_offsets = {0};
+    std::vector<int> add_facts;
+    std::vector<int> del_offsets = {0};
+    std::vector<int> del_facts;
+
+    void add_operator(int name, std::vector<int> preconditions,
+                      std::vector<int> add_effects,
+                      std::vector<int> del_effects, int cost = 1) {
+        names.push_back(name);
+        costs.push_back(cost);
+        _append(pre_offsets, pre_facts, preconditions);
+        _append(add_offsets, add_facts, add_effects);
+        _append(del_offsets, del_facts, del_effects);
+    }
+
+    int size() const { return (int)names.size(); }
+
+    FactRange preconditions(int op) const {
+        return _range(pre_offsets, pre_facts, op);
+    }
+    FactRange add_effects(int op) const {
+        return _range(add_offsets, add_facts, op);
+    }
+    FactRange del_effects(int op) const {
+        return _range(del_offsets, del_facts, op);
+    }
+
+    // The same operators without delete effects
+    OperatorTable relaxed() const {
+        OperatorTable table = *this;
+        table.del_offsets.assign(names.size() + 1, 0);
+        table.del_facts.clear();
+        return table;
+    }
+
+    bool applicable(int op, const PackedState& state) const {
+        for (int fact : preconditions(op)) {
+            if (!state.test(fact)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void apply(int op, const PackedState& state,
+               std::pair<size_t, PackedState>& result, size_t hash_val,
+               const std::vector<uint64_t>& zobrist_keys) const {
+        // assert(applicable(op, state));
+        // copies the words in place when `result` already has the same width
+        result.second.words.assign(state.words.begin(), state.words.end());
+        StateWord* words = result.second.data();
+        hash_val = _apply_effects(del_effects(op), words, false, hash_val,
+                                  zobrist_keys);
+        hash_val = _apply_effects(add_effects(op), words, true, hash_val,
+                                  zobrist_keys);
+        result.first = hash_val;
+    }
+
+   private:
+    static void _append(std::vector<int>& offsets, std::vector<int>& facts,
+                        std::vector<int>& list) {
+        std::sort(list.begin(), list.end());
+        list.erase(std::unique(list.begin(), list.end()), list.end());
+        facts.insert(facts.end(), list.begin(), list.end());
+        offsets.push_back((int)facts.size());
+    }
+
+    static FactRange _range(const std::vector<int>& offsets,
+                            const std::vector<int>& facts, int op) {
+        return FactRange(facts.data() + offsets[op],
+                         facts.data() + offsets[op + 1]);
+    }
+
+    static size_t _apply_effects(FactRange effects, StateWord* words,
+                                 bool add, size_t hash_val,
+                                 const std::vector<uint64_t>& zobrist_keys) {
+        /*
+        The effects are sorted, so the facts that share a word form a run
+        and are applied together with one AND-NOT or OR.
+        */
+        int i = 0;
+        int n = effects.size();
+        while (i < n) {
+            int word_idx = effects[i] / STATE_WORD_BITS;
+            StateWord mask = 0;
+            for (; i < n && effects[i] / STATE_WORD_BITS == word_idx; i++) {
+                mask |= StateWord(1) << (effects[i] % STATE_WORD_BITS);
+            }
+            StateWord changed;
+            if (add) {
+                changed = ~words[word_idx] & mask;
+                words[word_idx] |= mask;
+            } else {
+                changed = words[word_idx] & mask;
+                words[word_idx] &= ~mask;
+            }
+            hash_val = toggle_zobrist_hash(hash_val, word_idx, changed,
+                                           zobrist_keys);
+        }
+        return hash_val;
+    }
+};
@@ -4,7 +4,6 @@
 #include <functional>
 #include <limits>
 #include <memory>
-#include <queue>
 #include <set>
 #include <string>
 #include <tuple>
@@ -14,62 +13,97 @@
 #include "../heuristic/base.h"
 #include "../task.h"
 #include "breadth_first_search.h"
+#include "open_list.h"
 #include "searchspace.h"
 
 const int INF = std::numeric_limits<int>::max();
 
-inline std::vector<int> astar(BaseTask& planning_task, Heuristic& heuristic) {
+// An A* open list entry: a state and the g value it was queued with
+struct AStarEntry {
+    StateID state_id = NO_STATE;
+    int g = 0;
+};
+
+/*
+A* with integer g values. "open_list" is any open list that orders its
+entries by (f, h) and provides push(f, h, entry), pop() and empty(),
+e.g. BucketOpenList<AStarEntry>. States whose heuristic value is infinite
+are dead ends and are never inserted. A state whose g value improves is
+reopened and queued again; the outdated entries are skipped when popped.
+With weight w > 1 the search is weighted A* and uses f = g + w * h.
+
+States with g + h > cost_bound are pruned, so only plans of cost at most
+cost_bound are found if the heuristic is admissible. Successors are
+evaluated with calculate_h_bounded(), which lets h_max stop as soon as
+the state is known to exceed the bound.
+*/
+template <typename OpenList>
+std::vector<int> astar(BaseTask& planning_task, Heuristic& heuristic,
+                       OpenList& open_list, int weight = 1,
+                       int cost_bound = INF) {
     int iteration = 0;
     int expansions = 0;
-    std::priority_queue<tuple<float, float, int>> queue;
-    std::vector<SearchNode> nodes;
-    nodes.push_back(make_root_node(planning_task.initial_state));
-    float h = heuristic.calculate_h(0, nodes);
-    std::cout << "Initial h value: " << h << "\n";
-    queue.push({-1.0 * (h + (float)nodes[0].g), -h, 0});
+    SearchSpace space;
+    heuristic.initialize(space);
+    StateRegistry registry(planning_task.num_state_words,
+                           planning_task.variables);
+    PackedState state = planning_task.get_initial_state();
+    StateID initial_state_id =
+        registry.insert_state(state, planning_task.hash_state(state)).first;
+    space.open_initial(initial_state_id);
+    float initial_h = heuristic.calculate_h(state, initial_state_id, space);
+    std::cout << "Initial h value: " << initial_h << "\n";
+    int h = to_bucket_key(initial_h);
+    if (h != DEAD_END && h <= cost_bound) {
+        open_list.push(weight * h, h, AStarEntry{initial_state_id, 0});
+    } else {
+        space.mark_dead_end(initial_state_id);
+    }
 
-    flat_hash_map<size_t, int> state_cost = {{nodes[0].hash_value, 0}};
-    std::vector<std::pair<int, pair<size_t, flat_hash_set<int>>>> successors;
-    tuple<float, float, int> front_status;
-    int node_idx, succ_g, old_succ_g;
+    std::vector<std::pair<int, pair<size_t, PackedState>>> successors;
+    int succ_g;
+    bool exact;
 
-    while (!queue.empty()) {
+    while (!open_list.empty()) {
         ++iteration;
 
-        front_status = queue.top();
-        node_idx = get<2>(front_status);
-        queue.pop();
+        AStarEntry entry = open_list.pop();
+        SearchNodeInfo& info = space[entry.state_id];
+        if (info.status != NodeStatus::OPEN || info.g != entry.g) {
+            continue;
+        }
 
-        if (state_cost[nodes[node_idx].hash_value] == nodes[node_idx].g) {
-            expansions++;
-            if (planning_task.goal_reached(nodes[node_idx].state)) {
-                std::cout << iteration << " Nodes expanded\n";
-                return extract_solution(node_idx, nodes);
-            }
+        expansions++;
+        registry.unpack(entry.state_id, state);
+        if (planning_task.goal_reached(state)) {
+            std::cout << iteration << " Nodes expanded\n";
+            return space.extract_solution(entry.state_id);
+        }
+        space.close(entry.state_id);
 
-            successors.clear();
-            planning_task.get_successor_states(
-                nodes[node_idx].state, successors, nodes[node_idx].hash_value);
-            for (auto& opss : successors) {
-                // SearchNode succ_node =
-                nodes.emplace_back(
-                    make_child_node(node_idx, nodes[node_idx].g, opss.first,
-                                    opss.second.second, opss.second.first));
-                // nodes.emplace_back(succ_node);
-                h = heuristic.calculate_h(nodes.size() - 1, nodes);
-                old_succ_g = INF;
-                succ_g = nodes[nodes.size() - 1].g;
-                if (state_cost.find(opss.second.first) != state_cost.end()) {
-                    old_succ_g = state_cost[opss.second.first];
-                    if (succ_g < old_succ_g) {
-                        queue.push(
-                            {-1 * (h + (float)succ_g), -h, nodes.size() - 1});
-                        state_cost[opss.second.first] = succ_g;
-                    }
+        planning_task.get_successor_states(state, successors,
+                                           registry.get_hash(entry.state_id));
+        for (auto& opss : successors) {
+            StateID succ_id =
+                registry
+                    .insert_state(opss.second.second, opss.second.first)
+                    .first;
+            succ_g = entry.g + 1;
+            SearchNodeInfo& succ_info = space[succ_id];
+            if (succ_info.status != NodeStatus::DEAD_END &&
+                succ_g < succ_info.g) {
+                space.open(succ_id, entry.state_id, opss.first);
+                h = to_bucket_key(heuristic.calculate_h_bounded(
+                    opss.second.second, succ_id, space,
+                    (float)cost_bound - succ_g, exact));
+                if (!exact || (h != DEAD_END && h > cost_bound - succ_g)) {
+                    continue;  // pruned by the cost bound
+                }
+                if (h != DEAD_END) {
+                    open_list.push(succ_g + weight * h, h,
+                                   AStarEntry{succ_id, succ_g});
                 } else {
-                    queue.push(
-                        {-1 * (h + (float)succ_g), -h, nodes.size() - 1});
-                    state_cost.emplace(opss.second.first, succ_g);
+                    space.mark_dead_end(succ_id);
                 }
             }
         }
@@ -79,3 +113,17 @@ inline std::vector<int> astar(BaseTask& planning_task, Heuristic& heuristic) {
     std::cerr << "No solution found" << std::endl;
     return {};  // No solution found
 }
+
+inline std::vector<int> astar(BaseTask& planning_task, Heuristic& heuristic,
+                              TieBreaking tie_breaking = TieBreaking::LIFO,
+                              int cost_bound = INF) {
+    BucketOpenList<AStarEntry> open_list(tie_breaking);
+    return astar(planning_task, heuristic, open_list, 1, cost_bound);
+}
+
+inline std::vector<int> weighted_astar(
+    BaseTask& planning_task, Heuristic& heuristic, int weight,
+    TieBreaking tie_breaking = TieBreaking::LIFO, int cost_bound = INF) {
+    BucketOpenList<AStarEntry> open_list(tie_breaking);
+    return astar(planning_task, heuristic, open_list, weight, cost_bound);
+}
@@ -14,34 +14,38 @@
 
 inline std::vector<int> breadth_first_search(BaseTask& planning_task) {
     int iteration = 0;
-    std::queue<int> queue;
-    std::vector<SearchNode> nodes;
-    nodes.push_back(make_root_node(planning_task.initial_state));
-    queue.push(0);
+    std::queue<StateID> queue;
+    SearchSpace space;
+    StateRegistry registry(planning_task.num_state_words,
+                           planning_task.variables);
+    PackedState state = planning_task.get_initial_state();
+    StateID initial_state_id =
+        registry.insert_state(state, planning_task.hash_state(state)).first;
+    space.open_initial(initial_state_id);
+    queue.push(initial_state_id);
 
-    flat_hash_set<size_t> closed = {nodes[0].hash_value};
-    std::vector<std::pair<int, pair<size_t, flat_hash_set<int>>>> successors;
-    int node_idx;
+    std::vector<std::pair<int, pair<size_t, PackedState>>> successors;
+    StateID state_id;
     while (!queue.empty()) {
         ++iteration;
 
-        node_idx = queue.front();
+        state_id = queue.front();
         queue.pop();
 
-        if (planning_task.goal_reached(nodes[node_idx].state)) {
+        registry.unpack(state_id, state);
+        if (planning_task.goal_reached(state)) {
             std::cout << iteration << " Nodes expanded" << std::endl;
-            return extract_solution(node_idx, nodes);
+            return space.extract_solution(state_id);
         }
-        successors.clear();
-        planning_task.get_successor_states(nodes[node_idx].state, successors,
-                                           nodes[node_idx].hash_value);
+        space.close(state_id);
+        planning_task.get_successor_states(state, successors,
+                                           registry.get_hash(state_id));
         for (auto& opss : successors) {
-            if (closed.find(opss.second.first) == closed.end()) {
-                nodes.emplace_back(
-                    make_child_node(node_idx, nodes[node_idx].g, opss.first,
-                                    opss.second.second, opss.second.first));
-                queue.push(nodes.size() - 1);
-                closed.emplace(opss.second.first);
+            auto [succ_id, is_new] =
+                registry.insert_state(opss.second.second, opss.second.first);
+            if (is_new) {
+                space.open(succ_id, state_id, opss.first);
+                queue.push(succ_id);
             }
         }
     }
@@ -0,0 +1,119 @@
+#pragma once
+#include <iostream>
+#include <vector>
+
+#include "../heuristic/base.h"
+#include "../task.h"
+#include "open_list.h"
+#include "searchspace.h"
+
+/*
+Greedy best-first search: always expands a state with the smallest
+heuristic value. Every state is evaluated once, when it is first
+generated, and is never reopened. "open_list" orders its StateID entries
+by (h, 0) and provides push(h, 0, entry, preferred), pop(), empty() and
+boost_preferred(), e.g. AlternationOpenList<StateID>.
+
+With "preferred_operators" the heuristic also reports the preferred
+operators of every state it evaluates. They are kept in a per-state table
+of the search space until the state is expanded, so no state is evaluated
+twice. Successors reached by them are also queued as preferred, and the
+preferred queue is boosted whenever a new best h value is found.
+*/
+template <typename OpenList>
+std::vector<int> greedy_best_first_search(BaseTask& planning_task,
+                                          Heuristic& heuristic,
+                                          OpenList& open_list,
+                                          bool preferred_operators) {
+    int iteration = 0;
+    SearchSpace space;
+    heuristic.initialize(space);
+    heuristic.compute_preferred_operators = preferred_operators;
+    // the preferred operators of the states that were evaluated but not
+    // expanded yet
+    PerStateTable<std::vector<int>>* preferred_of =
+        preferred_operators ? &space.register_table<std::vector<int>>()
+                            : nullptr;
+    StateRegistry registry(planning_task.num_state_words,
+                           planning_task.variables);
+    PackedState state = planning_task.get_initial_state();
+    StateID initial_state_id =
+        registry.insert_state(state, planning_task.hash_state(state)).first;
+    space.open_initial(initial_state_id);
+    float initial_h = heuristic.calculate_h(state, initial_state_id, space);
+    std::cout << "Initial h value: " << initial_h << "\n";
+    int h = to_bucket_key(initial_h);
+    int best_h = h;
+    if (h != DEAD_END) {
+        if (preferred_of) {
+            (*preferred_of)[initial_state_id] = heuristic.preferred_operators;
+        }
+        open_list.push(h, 0, initial_state_id);
+    } else {
+        space.mark_dead_end(initial_state_id);
+    }
+
+    std::vector<std::pair<int, pair<size_t, PackedState>>> successors;
+    flat_hash_set<int> preferred;
+    StateID state_id;
+    while (!open_list.empty()) {
+        state_id = open_list.pop();
+        if (space[state_id].status != NodeStatus::OPEN) {
+            continue;  // queued as preferred and regular
+        }
+        ++iteration;
+
+        registry.unpack(state_id, state);
+        if (planning_task.goal_reached(state)) {
+            std::cout << iteration << " Nodes expanded" << std::endl;
+            return space.extract_solution(state_id);
+        }
+        space.close(state_id);
+
+        preferred.clear();
+        if (preferred_of) {
+            // a state is expanded only once, so its entry can be released
+            std::vector<int> state_preferred;
+            state_preferred.swap((*preferred_of)[state_id]);
+            preferred.insert(state_preferred.begin(), state_preferred.end());
+        }
+
+        planning_task.get_successor_states(state, successors,
+                                           registry.get_hash(state_id));
+        for (auto& opss : successors) {
+            auto [succ_id, is_new] =
+                registry.insert_state(opss.second.second, opss.second.first);
+            if (!is_new) {
+                continue;
+            }
+            space.open(succ_id, state_id, opss.first);
+            h = to_bucket_key(
+                heuristic.calculate_h(opss.second.second, succ_id, space));
+            if (h == DEAD_END) {
+                space.mark_dead_end(succ_id);
+                continue;
+            }
+            if (preferred_of) {
+                (*preferred_of)[succ_id] = heuristic.preferred_operators;
+            }
+            if (h < best_h) {
+                best_h = h;
+                open_list.boost_preferred();
+            }
+            open_list.push(h, 0, succ_id, preferred.count(opss.first) > 0);
+        }
+    }
+
+    std::cout << iteration << " Nodes expanded" << std::endl;
+    std::cerr << "No solution found" << std::endl;
+    return {};  // No solution found
+}
+
+inline std::vector<int> greedy_best_first_search(
+    BaseTask& planning_task, Heuristic& heuristic,
+    bool preferred_operators = false,
+    TieBreaking tie_breaking = TieBreaking::FIFO) {
+    AlternationOpenList<StateID> open_list(tie_breaking);
+    return greedy_best_first_search(planning_task, heuristic, open_list,
+                                    preferred_operators);
+}
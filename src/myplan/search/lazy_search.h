@@ -0,0 +1,142 @@
+#pragma once
+#include <iostream>
+#include <vector>
+
+#include "../heuristic/base.h"
+#include "../task.h"
+#include "open_list.h"
+#include "searchspace.h"
+
+// A lazy search open list entry: the state reached by "action" from
+// "parent_id" with cost g, which is evaluated when it is popped
+struct LazyEntry {
+    StateID state_id = NO_STATE;
+    StateID parent_id = NO_STATE;
+    int action = -1;
+    int g = 0;
+};
+
+/*
+Best-first search with deferred evaluation. Successors are queued with the
+heuristic value of their parent and are only evaluated when they are
+popped, so a state that is never expanded is never evaluated.
+
+If "greedy" is true the open list is ordered by h and states are never
+reopened (lazy GBFS). Otherwise it is ordered by (g + weight * h, h) and a
+state is reopened when it is reached with a smaller g (lazy weighted A*).
+"open_list" provides push(key, tie_key, entry, preferred), pop(), empty()
+and boost_preferred(), e.g. AlternationOpenList<LazyEntry>.
+
+With "preferred_operators" the successors reached by a preferred operator
+of the evaluated state are also queued as preferred, and the preferred
+queue is boosted whenever a new best h value is found.
+*/
+template <typename OpenList>
+std::vector<int> lazy_search(BaseTask& planning_task, Heuristic& heuristic,
+                             OpenList& open_list, bool greedy, int weight,
+                             bool preferred_operators) {
+    int iteration = 0;
+    int evaluations = 0;
+    int best_h = DEAD_END;
+    SearchSpace space;
+    heuristic.initialize(space);
+    heuristic.compute_preferred_operators = preferred_operators;
+    StateRegistry registry(planning_task.num_state_words,
+                           planning_task.variables);
+    PackedState state = planning_task.get_initial_state();
+    StateID initial_state_id =
+        registry.insert_state(state, planning_task.hash_state(state)).first;
+    open_list.push(0, 0, LazyEntry{initial_state_id, NO_STATE, -1, 0});
+
+    std::vector<std::pair<int, pair<size_t, PackedState>>> successors;
+    flat_hash_set<int> preferred;
+    while (!open_list.empty()) {
+        LazyEntry entry = open_list.pop();
+        SearchNodeInfo& info = space[entry.state_id];
+        if (info.status == NodeStatus::DEAD_END ||
+            (info.status != NodeStatus::NEW &&
+             (greedy || entry.g >= info.g))) {
+            continue;
+        }
+        ++iteration;
+
+        if (entry.parent_id == NO_STATE) {
+            space.open_initial(entry.state_id);
+        } else {
+            space.open(entry.state_id, entry.parent_id, entry.action);
+        }
+        registry.unpack(entry.state_id, state);
+        if (planning_task.goal_reached(state)) {
+            std::cout << iteration << " Nodes expanded" << std::endl;
+            std::cout << evaluations << " States evaluated" << std::endl;
+            return space.extract_solution(entry.state_id);
+        }
+
+        float h_value = heuristic.calculate_h(state, entry.state_id, space);
+        evaluations++;
+        if (entry.parent_id == NO_STATE) {
+            std::cout << "Initial h value: " << h_value << "\n";
+        }
+        int h = to_bucket_key(h_value);
+        if (h == DEAD_END) {
+            space.mark_dead_end(entry.state_id);
+            continue;
+        }
+        space.close(entry.state_id);
+        if (h < best_h) {
+            if (best_h != DEAD_END) {
+                open_list.boost_preferred();
+            }
+            best_h = h;
+        }
+        preferred.clear();
+        if (preferred_operators) {
+            preferred.insert(heuristic.preferred_operators.begin(),
+                             heuristic.preferred_operators.end());
+        }
+
+        int succ_g = info.g + 1;
+        int key = greedy ? h : succ_g + weight * h;
+        int tie_key = greedy ? 0 : h;
+        planning_task.get_successor_states(state, successors,
+                                           registry.get_hash(entry.state_id));
+        for (auto& opss : successors) {
+            StateID succ_id =
+                registry
+                    .insert_state(opss.second.second, opss.second.first)
+                    .first;
+            NodeStatus status = space[succ_id].status;
+            if (status == NodeStatus::NEW ||
+                (!greedy && status != NodeStatus::DEAD_END &&
+                 succ_g < space[succ_id].g)) {
+                open_list.push(key, tie_key,
+                               LazyEntry{succ_id, entry.state_id, opss.first,
+                                         succ_g},
+                               preferred.count(opss.first) > 0);
+            }
+        }
+    }
+
+    std::cout << iteration << " Nodes expanded" << std::endl;
+    std::cout << evaluations << " States evaluated" << std::endl;
+    std::cerr << "No solution found" << std::endl;
+    return {};  // No solution found
+}
+
+inline std::vector<int> lazy_greedy_best_first_search(
+    BaseTask& planning_task, Heuristic& heuristic,
+    bool preferred_operators = false,
+    TieBreaking tie_breaking = TieBreaking::FIFO) {
+    AlternationOpenList<LazyEntry> open_list(tie_breaking);
+    return lazy_search(planning_task, heuristic, open_list, true, 1,
+                       preferred_operators);
+}
+
+inline std::vector<int> lazy_weighted_astar(
+    BaseTask& planning_task, Heuristic& heuristic, int weight,
+    bool preferred_operators = false,
+    TieBreaking tie_breaking = TieBreaking::FIFO) {
+    AlternationOpenList<LazyEntry> open_list(tie_breaking);
+    return lazy_search(planning_task, heuristic, open_list, false, weight,
+                       preferred_operators);
+}
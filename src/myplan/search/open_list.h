@@ -0,0 +1,172 @@
+#pragma once
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+enum class TieBreaking { FIFO, LIFO };
+
+const int DEAD_END = std::numeric_limits<int>::max();
+
+/*
+Round a heuristic value up to an integer bucket key. Fractional values
+(e.g. from cost-partitioned landmarks) are rounded up, which keeps an
+admissible heuristic admissible when all costs are integers; the small
+tolerance absorbs float rounding errors of sums like 1/3 + 1/3 + 1/3.
+Unreachable goals (infinite or float max) are mapped to DEAD_END.
+*/
+inline int to_bucket_key(float h) {
+    if (!(h < (float)DEAD_END)) {
+        return DEAD_END;
+    }
+    return (int)std::ceil(h - 1e-4f);
+}
+
+template <typename Entry>
+class BucketOpenList {
+    /*
+    An open list for non-negative integer keys with two levels: entries are
+    ordered by the primary key (e.g. f), then by the secondary key (e.g. h),
+    and entries with equal keys are returned in FIFO or LIFO order.
+
+    Every (primary, secondary) pair owns a bucket and the smallest non-empty
+    primary and secondary keys are cached, so push and pop are O(1)
+    amortized and never compare entries. The cached minima only move
+    forward until a push with a smaller key resets them, which keeps
+    non-monotone keys (inconsistent heuristics) correct.
+    */
+   public:
+    BucketOpenList(TieBreaking tie_breaking = TieBreaking::LIFO)
+        : tie_breaking(tie_breaking) {}
+
+    void push(int primary, int secondary, const Entry& entry) {
+        assert(primary >= 0 && secondary >= 0);
+        if (primary >= (int)layers.size()) {
+            layers.resize(primary + 1);
+        }
+        Layer& layer = layers[primary];
+        if (secondary >= (int)layer.buckets.size()) {
+            layer.buckets.resize(secondary + 1);
+        }
+        layer.buckets[secondary].entries.push_back(entry);
+        layer.num_entries++;
+        if (secondary < layer.min_key) {
+            layer.min_key = secondary;
+        }
+        if (primary < min_key) {
+            min_key = primary;
+        }
+        num_entries++;
+    }
+
+    // Remove and return an entry with the smallest keys
+    Entry pop() {
+        assert(!empty());
+        while (layers[min_key].num_entries == 0) {
+            min_key++;
+        }
+        Layer& layer = layers[min_key];
+        while (layer.buckets[layer.min_key].empty()) {
+            layer.min_key++;
+        }
+        Bucket& bucket = layer.buckets[layer.min_key];
+        Entry entry;
+        if (tie_breaking == TieBreaking::FIFO) {
+            entry = bucket.entries[bucket.head++];
+        } else {
+            entry = bucket.entries.back();
+            bucket.entries.pop_back();
+        }
+        if (bucket.empty()) {
+            bucket.entries.clear();
+            bucket.head = 0;
+        }
+        layer.num_entries--;
+        num_entries--;
+        return entry;
+    }
+
+    // The primary key of the next entry to be popped
+    int min_primary_key() {
+        assert(!empty());
+        while (layers[min_key].num_entries == 0) {
+            min_key++;
+        }
+        return min_key;
+    }
+
+    bool empty() const { return num_entries == 0; }
+    size_t size() const { return num_entries; }
+
+    void clear() {
+        layers.clear();
+        min_key = std::numeric_limits<int>::max();
+        num_entries = 0;
+    }
+
+   private:
+    struct Bucket {
+        std::vector<Entry> entries;
+        size_t head = 0;  // first live entry (FIFO pops from the front)
+        bool empty() const { return head == entries.size(); }
+    };
+
+    struct Layer {
+        std::vector<Bucket> buckets;
+        int min_key = std::numeric_limits<int>::max();
+        size_t num_entries = 0;
+    };
+
+    TieBreaking tie_breaking;
+    std::vector<Layer> layers;
+    int min_key = std::numeric_limits<int>::max();
+    size_t num_entries = 0;
+};
+
+template <typename Entry>
+class AlternationOpenList {
+    /*
+    A regular and a preferred BucketOpenList that are used in turn. Every
+    entry goes into the regular queue and entries reached by a preferred
+    operator also go into the preferred queue. Each queue has a priority
+    counter: pop() takes from the non-empty queue with the smaller counter
+    and increments it. boost_preferred() lowers the counter of the
+    preferred queue, so that it is used exclusively for a while after the
+    search made progress.
+    */
+   public:
+    AlternationOpenList(TieBreaking tie_breaking = TieBreaking::FIFO,
+                        int boost = 1000)
+        : regular(tie_breaking), preferred(tie_breaking), boost(boost) {}
+
+    void push(int primary, int secondary, const Entry& entry,
+              bool is_preferred = false) {
+        regular.push(primary, secondary, entry);
+        if (is_preferred) {
+            preferred.push(primary, secondary, entry);
+        }
+    }
+
+    Entry pop() {
+        assert(!empty());
+        if (preferred.empty() ||
+            (!regular.empty() && regular_priority < preferred_priority)) {
+            regular_priority++;
+            return regular.pop();
+        }
+        preferred_priority++;
+        return preferred.pop();
+    }
+
+    void boost_preferred() { preferred_priority -= boost; }
+
+    bool empty() const { return regular.empty() && preferred.empty(); }
+    size_t size() const { return regular.size() + preferred.size(); }
+
+   private:
+    BucketOpenList<Entry> regular;
+    BucketOpenList<Entry> preferred;
+    int boost;
+    int regular_priority = 0;
+    int preferred_priority = 0;
+};
@@ -1,72 +1,149 @@
 #pragma once
 #include <algorithm>
-#include <any>
-#include <functional>
+#include <cstdint>
 #include <iostream>
+#include <limits>
 #include <memory>
-#include <set>
-#include <string>
-#include <unordered_map>
-#include <unordered_set>
 #include <vector>
 
 #include "../parallel_hashmap/phmap.h"
+#include "../segmented_vector.h"
+#include "../state.h"
+#include "state_registry.h"
 
 using phmap::flat_hash_map;
 using phmap::flat_hash_set;
 
-inline size_t hash_unordered_set(const flat_hash_set<int>& ss) {
-    size_t seed = 0;
-    for (int x : ss) {
-        seed ^= std::hash<std::string>{}(std::to_string(x));
+enum class NodeStatus : uint8_t { NEW, OPEN, CLOSED, DEAD_END };
+
+// The search information of one registered state, 16 bytes
+struct SearchNodeInfo {
+    StateID parent_id = NO_STATE;
+    int action = -1;  // the operator that created the state
+    int g = std::numeric_limits<int>::max();
+    NodeStatus status = NodeStatus::NEW;
+};
+
+struct PerStateTableBase {
+    virtual ~PerStateTableBase() = default;
+};
+
+template <typename T>
+struct PerStateTable : PerStateTableBase {
+    // Data of type T for every state, indexed by StateID
+    SegmentedVector<T> entries;
+
+    PerStateTable(const T& default_value) : entries(default_value) {}
+
+    T& operator[](StateID id) {
+        if ((size_t)id >= entries.size()) {
+            entries.resize(id + 1);
+        }
+        return entries[id];
     }
-    return seed;
-}
+};
 
-class SearchNode {
+class PerStateBitset : public PerStateTableBase {
+    /*
+    A bitset of "num_bits" bits for every state, all stored in one arena of
+    words like the packed states of the StateRegistry. The pointer returned
+    by operator[] is invalidated when a state with a larger id is accessed.
+    */
    public:
-    // Constructo
-    // SearchNode() {}
-    SearchNode(flat_hash_set<int>& state, int parent_id, int action, int g,
-               size_t hash_value)
-        : state(state),
-          parent_id(parent_id),
-          action(action),
-          g(g),
-          hash_value(hash_value) {}
-
-    flat_hash_set<int> state;
-    flat_hash_set<int> unreached;
-    int parent_id;
-    int action;
-    int g;
-    size_t hash_value;
+    PerStateBitset(int num_bits)
+        : num_words(get_num_state_words(num_bits)) {}
+
+    uint64_t* operator[](StateID id) {
+        size_t end = ((size_t)id + 1) * num_words;
+        if (end > words.size()) {
+            words.resize(end, 0);
+        }
+        return words.data() + (size_t)id * num_words;
+    }
+
+    int size_in_words() const { return num_words; }
+
+   private:
+    int num_words;
+    std::vector<uint64_t> words;
 };
 
-// Extract the solution from the search space
-inline std::vector<int> extract_solution(int this_id,
-                                         std::vector<SearchNode>& nodes) {
-    int node_id = this_id;
-    std::vector<int> solution;
-    while (nodes[node_id].parent_id != -1) {
-        // std::cout << node->action << std::endl;
-        solution.push_back(nodes[node_id].action);
-        node_id = nodes[node_id].parent_id;
+class SearchSpace {
+    /*
+    The search information of all states reached by a search, indexed by
+    StateID. A state has a single record no matter how often it is
+    reached; improving its g value overwrites the record in place.
+    Records live in a segmented vector, so they are never relocated as the
+    search grows.
+
+    Data that only some heuristics need (e.g. the landmarks that are still
+    unreached) is not part of the record: a heuristic registers its own
+    per-state table, which is owned by the search space and therefore
+    lives exactly as long as the search.
+    */
+   public:
+    SearchSpace() {}
+    SearchSpace(const SearchSpace&) = delete;
+    SearchSpace& operator=(const SearchSpace&) = delete;
+
+    // The record of the state "id", created as NEW on first access
+    SearchNodeInfo& operator[](StateID id) {
+        if ((size_t)id >= infos.size()) {
+            infos.resize(id + 1);
+        }
+        return infos[id];
     }
-    std::reverse(solution.begin(), solution.end());
-    return solution;
-}
-
-// Construct an initial search node
-inline SearchNode make_root_node(flat_hash_set<int>& initial_state) {
-    return SearchNode(initial_state, -1, -1, 0,
-                      hash_unordered_set(initial_state));
-}
-
-// Construct a new search node linked to a parent node
-inline SearchNode make_child_node(int parent_id, int parent_g, int action,
-                                  flat_hash_set<int>& state,
-                                  size_t hash_val) {
-    return SearchNode(state, parent_id, action, parent_g + 1, hash_val);
-}
 
+    void open_initial(StateID id) {
+        SearchNodeInfo& info = (*this)[id];
+        info.parent_id = NO_STATE;
+        info.action = -1;
+        info.g = 0;
+        info.status = NodeStatus::OPEN;
+    }
+
+    // Reach "id" (again) from "parent_id" by applying "action"
+    void open(StateID id, StateID parent_id, int action) {
+        int parent_g = (*this)[parent_id].g;
+        SearchNodeInfo& info = (*this)[id];
+        info.parent_id = parent_id;
+        info.action = action;
+        info.g = parent_g + 1;
+        info.status = NodeStatus::OPEN;
+    }
+
+    void close(StateID id) { (*this)[id].status = NodeStatus::CLOSED; }
+
+    void mark_dead_end(StateID id) {
+        (*this)[id].status = NodeStatus::DEAD_END;
+    }
+
+    // Extract the plan that reaches "goal_id"
+    std::vector<int> extract_solution(StateID goal_id) {
+        std::vector<int> solution;
+        StateID id = goal_id;
+        while ((*this)[id].parent_id != NO_STATE) {
+            solution.push_back((*this)[id].action);
+            id = (*this)[id].parent_id;
+        }
+        std::reverse(solution.begin(), solution.end());
+        return solution;
+    }
+
+    int size() const { return (int)infos.size(); }
+
+    template <typename T>
+    PerStateTable<T>& register_table(const T& default_value = T()) {
+        tables.emplace_back(new PerStateTable<T>(default_value));
+        return static_cast<PerStateTable<T>&>(*tables.back());
+    }
+
+    PerStateBitset& register_bitset(int num_bits) {
+        tables.emplace_back(new PerStateBitset(num_bits));
+        return static_cast<PerStateBitset&>(*tables.back());
+    }
+
+   private:
+    SegmentedVector<SearchNodeInfo> infos;
+    std::vector<std::unique_ptr<PerStateTableBase>> tables;
+};
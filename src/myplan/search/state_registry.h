@@ -0,0 +1,122 @@
+#pragma once
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "../parallel_hashmap/phmap.h"
+#include "../state.h"
+#include "../variables.h"
+
+using phmap::flat_hash_set;
+
+typedef int32_t StateID;
+const StateID NO_STATE = -1;
+
+class StateRegistry {
+    /*
+    Interns packed states. Every distinct state is stored exactly once in a
+    contiguous arena of words and is identified by a dense StateID
+    (0, 1, 2, ... in order of registration). Duplicate detection compares
+    the actual state contents, so two states with the same hash value are
+    never merged.
+
+    With a non-empty VariableLayout the arena holds the states packed into
+    the finite-domain variables of the task instead of their fact bitsets.
+    The layout must outlive the registry.
+    */
+   public:
+    StateRegistry(int num_words)
+        : num_words(num_words),
+          num_state_words(num_words),
+          table(0, StateIDHash(this), StateIDEqual(this)) {}
+
+    StateRegistry(int num_state_words, const VariableLayout& variables)
+        : num_words(variables.empty() ? num_state_words
+                                      : variables.packed_words()),
+          num_state_words(num_state_words),
+          layout(variables.empty() ? nullptr : &variables),
+          table(0, StateIDHash(this), StateIDEqual(this)) {}
+
+    StateRegistry(const StateRegistry&) = delete;
+    StateRegistry& operator=(const StateRegistry&) = delete;
+
+    /*
+    Register "state" whose hash value is "hash_value".
+    @return The id of the state and True if the state was not registered
+    before, False otherwise
+    */
+    std::pair<StateID, bool> insert_state(const PackedState& state,
+                                          size_t hash_value) {
+        assert(state.num_words() == num_state_words);
+        // Tentatively append the state so that it can be compared in place,
+        // and drop it again if it turns out to be a duplicate.
+        StateID id = (StateID)hashes.size();
+        if (layout) {
+            arena.resize(arena.size() + num_words);
+            layout->pack(state, arena.data() + (size_t)id * num_words);
+        } else {
+            arena.insert(arena.end(), state.words.begin(), state.words.end());
+        }
+        hashes.push_back(hash_value);
+        auto result = table.insert(id);
+        if (!result.second) {
+            arena.resize(arena.size() - num_words);
+            hashes.pop_back();
+            return std::make_pair(*result.first, false);
+        }
+        return std::make_pair(id, true);
+    }
+
+    const StateWord* lookup(StateID id) const {
+        return arena.data() + (size_t)id * num_words;
+    }
+
+    // Copy the words of the state "id" into "state"
+    void unpack(StateID id, PackedState& state) const {
+        const StateWord* words = lookup(id);
+        if (layout) {
+            state.words.resize(num_state_words);
+            layout->unpack(words, state);
+        } else {
+            state.words.assign(words, words + num_words);
+        }
+    }
+
+    // The number of words that every registered state occupies
+    int words_per_state() const { return num_words; }
+
+    PackedState get_state(StateID id) const {
+        PackedState state;
+        unpack(id, state);
+        return state;
+    }
+
+    size_t get_hash(StateID id) const { return hashes[id]; }
+
+    int size() const { return (int)hashes.size(); }
+
+   private:
+    struct StateIDHash {
+        const StateRegistry* registry;
+        StateIDHash(const StateRegistry* registry) : registry(registry) {}
+        size_t operator()(StateID id) const { return registry->hashes[id]; }
+    };
+
+    struct StateIDEqual {
+        const StateRegistry* registry;
+        StateIDEqual(const StateRegistry* registry) : registry(registry) {}
+        bool operator()(StateID lhs, StateID rhs) const {
+            return std::memcmp(registry->lookup(lhs), registry->lookup(rhs),
+                               registry->num_words * sizeof(StateWord)) == 0;
+        }
+    };
+
+    int num_words;        // per state in the arena
+    int num_state_words;  // of the unpacked fact bitsets
+    const VariableLayout* layout = nullptr;
+    std::vector<StateWord> arena;
+    std::vector<size_t> hashes;
+    flat_hash_set<StateID, StateIDHash, StateIDEqual> table;
+};
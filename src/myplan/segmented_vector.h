@@ -0,0 +1,59 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+template <typename T, int SEGMENT_BITS = 14>
+class SegmentedVector {
+    /*
+    A vector that stores its elements in fixed-size segments. Growing it
+    only allocates a new segment, so elements are never moved or copied
+    once created and references to them stay valid while the vector lives.
+    */
+   public:
+    static const size_t SEGMENT_SIZE = size_t(1) << SEGMENT_BITS;
+
+    SegmentedVector(const T& default_value = T())
+        : default_value(default_value), num_elements(0) {}
+
+    SegmentedVector(const SegmentedVector&) = delete;
+    SegmentedVector& operator=(const SegmentedVector&) = delete;
+    SegmentedVector(SegmentedVector&&) = default;
+    SegmentedVector& operator=(SegmentedVector&&) = default;
+
+    T& operator[](size_t idx) {
+        assert(idx < num_elements);
+        return segments[idx >> SEGMENT_BITS][idx & (SEGMENT_SIZE - 1)];
+    }
+    const T& operator[](size_t idx) const {
+        assert(idx < num_elements);
+        return segments[idx >> SEGMENT_BITS][idx & (SEGMENT_SIZE - 1)];
+    }
+
+    // Grow to at least "size" elements, filling with the default value
+    void resize(size_t size) {
+        while (segments.size() * SEGMENT_SIZE < size) {
+            std::unique_ptr<T[]> segment(new T[SEGMENT_SIZE]);
+            for (size_t i = 0; i < SEGMENT_SIZE; i++) {
+                segment[i] = default_value;
+            }
+            segments.push_back(std::move(segment));
+        }
+        if (size > num_elements) {
+            num_elements = size;
+        }
+    }
+
+    void push_back(const T& value) {
+        resize(num_elements + 1);
+        (*this)[num_elements - 1] = value;
+    }
+
+    size_t size() const { return num_elements; }
+
+   private:
+    T default_value;
+    size_t num_elements;
+    std::vector<std::unique_ptr<T[]>> segments;
+};
@@ -8,105 +8,101 @@
 
 template <typename KeyType, typename ValueType>
 class SetTrie {
+    /*
+    A trie over sorted key sets that answers "which stored sets are subsets
+    of the query set" queries.
+
+    All nodes live in one contiguous pool and refer to their children by
+    index, with the children of a node kept sorted by key. The trie
+    therefore owns all of its memory, can be copied and moved like any other
+    value and needs no explicit destruction.
+    */
    public:
-    std::vector<std::vector<ValueType>> nested_result;
     struct Node {
-        std::vector<Node*> children;
-        bool flag_last = false;
         KeyType data;
+        bool flag_last = false;
+        std::vector<KeyType> child_keys;  // sorted
+        std::vector<int> child_ids;       // child_ids[i] has child_keys[i]
         std::vector<ValueType> values;
-        Node(KeyType data = KeyType(),
-             std::vector<ValueType> values = std::vector<ValueType>())
-            : data(data), values(values) {}
-
-        bool operator==(const Node& other) const { return data == other.data; }
-        bool operator!=(const Node& other) const { return data != other.data; }
-        bool operator<(const Node& other) const { return data < other.data; }
-        bool operator<=(const Node& other) const { return data <= other.data; }
-        bool operator>(const Node& other) const { return data > other.data; }
-        bool operator>=(const Node& other) const { return data >= other.data; }
+        Node(KeyType data = KeyType()) : data(data) {}
     };
 
-    SetTrie() : root(new Node()) {}
+    SetTrie() : nodes(1) {}
 
     SetTrie(std::vector<std::pair<std::set<KeyType>, std::vector<ValueType>>>
                 iterable)
-        : root(new Node()) {
+        : nodes(1) {
         for (const auto& pair : iterable) {
-            assign(pair.first, pair.second);
+            for (const ValueType& value : pair.second) {
+                assign(pair.first, value);
+            }
         }
     }
 
-    //~SetTrie() { destroy(root); }
-
-    void assign(std::set<KeyType> keyset, ValueType value) {
-        int valcnt = 0;
-        assignHelper(root, keyset.begin(), keyset.end(), value, valcnt);
+    void assign(const std::set<KeyType>& keyset, ValueType value) {
+        int node_id = 0;
+        for (const KeyType& key : keyset) {
+            node_id = get_or_create_child(node_id, key);
+        }
+        nodes[node_id].flag_last = true;
+        nodes[node_id].values.push_back(value);
     }
 
     std::vector<ValueType> subsets(std::set<KeyType>& keyset) {
         std::vector<ValueType> result;
-        subsetsHelper(root, keyset, result);
+        subsetsHelper(0, keyset, result);
         return result;
     }
 
     void subsets(std::set<KeyType>& keyset, std::vector<ValueType>& result) {
-        subsetsHelper(root, keyset, result);
+        subsetsHelper(0, keyset, result);
     }
 
-   private:
-    Node* root;
+    int size() const { return (int)nodes.size(); }
 
-    /*
-    void destroy(Node* node) {
-        for (auto child : node->children) {
-            destroy(child);
-        }
-        delete node;
-    }
-    */
+   private:
+    std::vector<Node> nodes;  // nodes[0] is the root
 
-    void assignHelper(Node* node, typename std::set<KeyType>::const_iterator it,
-                      typename std::set<KeyType>::const_iterator end,
-                      ValueType& value, int& valcnt) {
-        if (it != end) {
-            auto data = *it;
-            // find the first child with this data
-            auto nextNodeItr =
-                std::find_if(node->children.begin(), node->children.end(),
-                             [data](Node* n) { return n->data == data; });
-            Node* nextNodePtr;
-            if (nextNodeItr == node->children.end()) {
-                nextNodePtr = new Node(data);
-                node->children.push_back(nextNodePtr);
-            } else {
-                nextNodePtr = *(nextNodeItr);
-            }
-            it++;
-            assignHelper(nextNodePtr, it, end, value, valcnt);
-        } else {
-            node->flag_last = true;
-            node->values.push_back(value);
-            valcnt = (int)node->values.size();
+    int get_or_create_child(int node_id, const KeyType& key) {
+        std::vector<KeyType>& keys = nodes[node_id].child_keys;
+        auto it = std::lower_bound(keys.begin(), keys.end(), key);
+        size_t pos = it - keys.begin();
+        if (it != keys.end() && *it == key) {
+            return nodes[node_id].child_ids[pos];
         }
+        int child_id = (int)nodes.size();
+        // insert before push_back: the pool may reallocate
+        keys.insert(it, key);
+        nodes[node_id].child_ids.insert(
+            nodes[node_id].child_ids.begin() + pos, child_id);
+        nodes.emplace_back(key);
+        return child_id;
     }
 
-    void subsetsHelper(Node* node, std::set<KeyType>& keyset,
+    void subsetsHelper(int node_id, std::set<KeyType>& keyset,
                        std::vector<ValueType>& result) {
-        // path.push_back(node->data);
-
-        if (node->flag_last) {
-            result.insert(result.end(), node->values.begin(),
-                          node->values.end());
-            // result.emplace_back(node->values);
+        const Node& node = nodes[node_id];
+        if (node.flag_last) {
+            result.insert(result.end(), node.values.begin(),
+                          node.values.end());
         }
 
-        for (Node* child : node->children) {
-            if (keyset.find(child->data) != keyset.end()) {
-                subsetsHelper(child, keyset, result);
+        // Walk the smaller of the two sorted sequences and search the other.
+        if (node.child_keys.size() <= keyset.size()) {
+            for (size_t i = 0; i < node.child_keys.size(); i++) {
+                if (keyset.find(node.child_keys[i]) != keyset.end()) {
+                    subsetsHelper(node.child_ids[i], keyset, result);
+                }
+            }
+        } else {
+            const std::vector<KeyType>& keys = node.child_keys;
+            for (const KeyType& key : keyset) {
+                auto it = std::lower_bound(keys.begin(), keys.end(), key);
+                if (it != keys.end() && *it == key) {
+                    subsetsHelper(node.child_ids[it - keys.begin()], keyset,
+                                  result);
+                }
             }
         }
-
-        // path.pop_back();
     }
 };
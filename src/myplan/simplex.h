@@ -0,0 +1,196 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+enum class LPStatus { OPTIMAL, UNBOUNDED };
+
+class SimplexSolver {
+    /*
+    A dense primal simplex solver for linear programs of the form
+
+        maximize c^T x  subject to  A x <= b,  x >= 0,  with b >= 0.
+
+    Since b is non-negative, the slack basis is feasible and no first phase
+    is needed. The solver keeps the dictionary
+        x_B = rhs - T x_N
+    of its last basis, where T has one row per constraint and one column
+    per nonbasic variable (n columns for n structural variables), so a
+    pivot costs O(m * n) and skips the rows that do not contain the
+    entering variable.
+
+    Only the objective may change between solve() calls. The feasible
+    region stays the same, so the previous optimal basis is still feasible
+    and every solve is warm-started from it. To bound the numerical drift
+    of the dictionary, it is rebuilt from the slack basis after a fixed
+    number of pivots.
+    */
+   public:
+    SimplexSolver() {}
+
+    // "matrix" holds the m x n constraint matrix A in row-major order
+    SimplexSolver(int num_cols, std::vector<double> matrix,
+                  std::vector<double> bounds)
+        : num_rows((int)bounds.size()),
+          num_cols(num_cols),
+          matrix(std::move(matrix)),
+          bounds(std::move(bounds)) {
+        assert((int)this->matrix.size() == num_rows * num_cols);
+        reset();
+    }
+
+    int rows() const { return num_rows; }
+    int cols() const { return num_cols; }
+
+    // Go back to the slack basis
+    void reset() {
+        tableau = matrix;
+        rhs = bounds;
+        basic.resize(num_rows);
+        nonbasic.resize(num_cols);
+        for (int i = 0; i < num_rows; i++) {
+            basic[i] = num_cols + i;
+        }
+        for (int j = 0; j < num_cols; j++) {
+            nonbasic[j] = j;
+        }
+        pivots_since_reset = 0;
+    }
+
+    LPStatus solve(const std::vector<double>& objective) {
+        assert((int)objective.size() == num_cols);
+        if (pivots_since_reset > MAX_PIVOTS_BEFORE_RESET) {
+            reset();
+        }
+        price(objective);
+        int degenerate_pivots = 0;
+        while (true) {
+            // Dantzig's rule, and Bland's rule against cycling once the
+            // objective has stalled for a while
+            bool bland = degenerate_pivots > num_cols;
+            int col = -1;
+            for (int j = 0; j < num_cols; j++) {
+                if (reduced_costs[j] <= EPSILON) {
+                    continue;
+                }
+                if (col < 0 ||
+                    (bland ? nonbasic[j] < nonbasic[col]
+                           : reduced_costs[j] > reduced_costs[col])) {
+                    col = j;
+                }
+            }
+            if (col < 0) {
+                return LPStatus::OPTIMAL;
+            }
+            int row = -1;
+            double best_ratio = 0;
+            for (int i = 0; i < num_rows; i++) {
+                double a = tableau[i * num_cols + col];
+                if (a <= EPSILON) {
+                    continue;
+                }
+                double ratio = rhs[i] / a;
+                if (row < 0 || ratio < best_ratio - EPSILON ||
+                    (ratio <= best_ratio + EPSILON &&
+                     basic[i] < basic[row])) {
+                    row = i;
+                    best_ratio = ratio;
+                }
+            }
+            if (row < 0) {
+                return LPStatus::UNBOUNDED;
+            }
+            degenerate_pivots = best_ratio <= EPSILON ? degenerate_pivots + 1
+                                                      : 0;
+            pivot(row, col);
+        }
+    }
+
+    // The objective value of the last solve()
+    double objective_value() const { return value; }
+
+    // The values of the structural variables of the last solve()
+    std::vector<double> solution() const {
+        std::vector<double> x(num_cols, 0);
+        for (int i = 0; i < num_rows; i++) {
+            if (basic[i] < num_cols) {
+                x[basic[i]] = rhs[i];
+            }
+        }
+        return x;
+    }
+
+   private:
+    static constexpr double EPSILON = 1e-9;
+    static const int MAX_PIVOTS_BEFORE_RESET = 100000;
+
+    int num_rows = 0;
+    int num_cols = 0;
+    std::vector<double> matrix;  // A, kept for resets
+    std::vector<double> bounds;  // b, kept for resets
+    std::vector<double> tableau;
+    std::vector<double> rhs;
+    std::vector<int> basic;     // per row, the basic variable
+    std::vector<int> nonbasic;  // per column, the nonbasic variable
+    std::vector<double> reduced_costs;
+    std::vector<double> pivot_row;
+    double value = 0;
+    int pivots_since_reset = 0;
+
+    // Express the objective in the nonbasic variables of the current basis
+    void price(const std::vector<double>& objective) {
+        reduced_costs.assign(num_cols, 0);
+        value = 0;
+        for (int j = 0; j < num_cols; j++) {
+            if (nonbasic[j] < num_cols) {
+                reduced_costs[j] = objective[nonbasic[j]];
+            }
+        }
+        for (int i = 0; i < num_rows; i++) {
+            if (basic[i] >= num_cols || objective[basic[i]] == 0) {
+                continue;
+            }
+            double c = objective[basic[i]];
+            value += c * rhs[i];
+            const double* t = &tableau[i * num_cols];
+            for (int j = 0; j < num_cols; j++) {
+                reduced_costs[j] -= c * t[j];
+            }
+        }
+    }
+
+    void pivot(int row, int col) {
+        double* r = &tableau[row * num_cols];
+        double p = r[col];
+        for (int j = 0; j < num_cols; j++) {
+            r[j] /= p;
+        }
+        r[col] = 1 / p;
+        rhs[row] = std::max(0.0, rhs[row] / p);
+        pivot_row.assign(r, r + num_cols);
+
+        for (int i = 0; i < num_rows; i++) {
+            double* t = &tableau[i * num_cols];
+            double a = t[col];
+            if (i == row || a == 0) {
+                continue;
+            }
+            for (int j = 0; j < num_cols; j++) {
+                t[j] -= a * pivot_row[j];
+            }
+            t[col] = -a * pivot_row[col];
+            rhs[i] = std::max(0.0, rhs[i] - a * rhs[row]);
+        }
+        double d = reduced_costs[col];
+        for (int j = 0; j < num_cols; j++) {
+            reduced_costs[j] -= d * pivot_row[j];
+        }
+        reduced_costs[col] = -d * pivot_row[col];
+        value += d * rhs[row];
+
+        std::swap(basic[row], nonbasic[col]);
+        pivots_since_reset++;
+    }
+};
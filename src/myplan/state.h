@@ -0,0 +1,206 @@
+#pragma once
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "parallel_hashmap/phmap.h"
+
+using phmap::flat_hash_set;
+
+typedef uint64_t StateWord;
+const int STATE_WORD_BITS = 64;
+
+inline int get_num_state_words(int num_facts) {
+    return (num_facts + STATE_WORD_BITS - 1) / STATE_WORD_BITS;
+}
+
+/*
+Zobrist hashing: every fact gets a random 64-bit key and the hash value of a
+state is the XOR of the keys of its facts, so applying an operator only has
+to XOR the keys of the facts it actually adds or deletes.
+*/
+inline std::vector<uint64_t> make_zobrist_keys(int num_facts,
+                                               uint64_t seed = 2023) {
+    std::mt19937_64 rng(seed);
+    std::vector<uint64_t> keys(num_facts);
+    for (uint64_t& key : keys) {
+        key = rng();
+    }
+    return keys;
+}
+
+// XOR the keys of the facts in the word "word_idx" that are set in "changed"
+inline size_t toggle_zobrist_hash(size_t hash_val, int word_idx,
+                                  StateWord changed,
+                                  const std::vector<uint64_t>& keys) {
+    const uint64_t* word_keys = keys.data() + word_idx * STATE_WORD_BITS;
+    while (changed) {
+        hash_val ^= word_keys[__builtin_ctzll(changed)];
+        changed &= changed - 1;
+    }
+    return hash_val;
+}
+
+class PackedState {
+    /*
+    A state stored as a fixed-width bitset over the dense fact ids.
+    Bit i of the state is set if and only if fact i holds.
+    */
+   public:
+    std::vector<StateWord> words;
+
+    class const_iterator {
+        // Iterates over the ids of the facts that hold in the state.
+       public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = int;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const int*;
+        using reference = int;
+
+        const_iterator(const StateWord* words, int num_words, int word_idx)
+            : words(words), num_words(num_words), word_idx(word_idx), cur(0) {
+            if (word_idx < num_words) {
+                cur = words[word_idx];
+                skip_empty_words();
+            }
+        }
+
+        int operator*() const {
+            return word_idx * STATE_WORD_BITS + __builtin_ctzll(cur);
+        }
+
+        const_iterator& operator++() {
+            cur &= cur - 1;
+            skip_empty_words();
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator tmp = *this;
+            ++(*this);
+            return tmp;
+        }
+
+        bool operator==(const const_iterator& other) const {
+            return word_idx == other.word_idx && cur == other.cur;
+        }
+        bool operator!=(const const_iterator& other) const {
+            return !(*this == other);
+        }
+
+       private:
+        const StateWord* words;
+        int num_words;
+        int word_idx;
+        StateWord cur;
+
+        void skip_empty_words() {
+            while (cur == 0 && ++word_idx < num_words) {
+                cur = words[word_idx];
+            }
+        }
+    };
+
+    PackedState() {}
+    PackedState(int num_words) : words(num_words, 0) {}
+    PackedState(const flat_hash_set<int>& facts, int num_words)
+        : words(num_words, 0) {
+        for (int fact : facts) {
+            set(fact);
+        }
+    }
+
+    int num_words() const { return (int)words.size(); }
+    StateWord* data() { return words.data(); }
+    const StateWord* data() const { return words.data(); }
+
+    bool test(int fact) const {
+        assert(fact >= 0 && fact < num_words() * STATE_WORD_BITS);
+        return (words[fact / STATE_WORD_BITS] >>
+                (fact % STATE_WORD_BITS)) & 1;
+    }
+
+    void set(int fact) {
+        assert(fact >= 0 && fact < num_words() * STATE_WORD_BITS);
+        words[fact / STATE_WORD_BITS] |= StateWord(1)
+                                          << (fact % STATE_WORD_BITS);
+    }
+
+    void reset(int fact) {
+        assert(fact >= 0 && fact < num_words() * STATE_WORD_BITS);
+        words[fact / STATE_WORD_BITS] &= ~(StateWord(1)
+                                           << (fact % STATE_WORD_BITS));
+    }
+
+    // Number of facts that hold in the state
+    int size() const {
+        int cnt = 0;
+        for (StateWord w : words) {
+            cnt += __builtin_popcountll(w);
+        }
+        return cnt;
+    }
+
+    const_iterator begin() const {
+        return const_iterator(words.data(), num_words(), 0);
+    }
+    const_iterator end() const {
+        return const_iterator(words.data(), num_words(), num_words());
+    }
+
+    flat_hash_set<int> to_set() const {
+        return flat_hash_set<int>(begin(), end());
+    }
+
+    bool operator==(const PackedState& other) const {
+        return words == other.words;
+    }
+    bool operator!=(const PackedState& other) const {
+        return words != other.words;
+    }
+};
+
+class FactMask {
+    /*
+    A sparse bitmask over the fact ids: only the words that contain at
+    least one fact are stored, as (word index, bits) pairs, so a packed
+    state is tested against the mask with one AND per word.
+    */
+   public:
+    std::vector<std::pair<int, StateWord>> entries;
+
+    FactMask() {}
+    FactMask(const std::vector<int>& facts) {
+        for (int fact : facts) {
+            add(fact);
+        }
+    }
+
+    void add(int fact) {
+        int word_idx = fact / STATE_WORD_BITS;
+        StateWord bit = StateWord(1) << (fact % STATE_WORD_BITS);
+        for (auto& entry : entries) {
+            if (entry.first == word_idx) {
+                entry.second |= bit;
+                return;
+            }
+        }
+        entries.emplace_back(word_idx, bit);
+    }
+
+    bool empty() const { return entries.empty(); }
+
+    // True if all the facts of the mask hold in `words`
+    bool subset_of(const StateWord* words) const {
+        for (auto& [word_idx, mask] : entries) {
+            if ((words[word_idx] & mask) != mask) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
@@ -0,0 +1,197 @@
+#pragma once
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "operator_table.h"
+#include "state.h"
+
+class SuccessorGenerator {
+    /*
+    A decision tree over the fact ids that enumerates the operators
+    applicable in a packed state.
+
+    Every node switches on one fact: its "true" subtree contains the
+    operators that need this fact, and the operators that do not need it
+    are found after the subtree. The node also owns a (possibly empty) leaf
+    range of operators whose preconditions are all satisfied once the node
+    is reached. Nodes are stored in preorder in one flat array and each node
+    knows where its true subtree ends ("skip"), so a query is a single
+    forward scan that either steps into the true subtree or skips it. No
+    stack and no allocation is needed, which also makes lazy iteration cheap.
+    */
+   public:
+    struct Node {
+        int fact;       // fact tested by this node, -1 for a pure leaf
+        int skip;       // first node after the true subtree
+        int ops_begin;  // leaf range in leaf_operators
+        int ops_end;
+    };
+
+    class const_iterator {
+        // Iterates over the indices of the applicable operators.
+       public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = int;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const int*;
+        using reference = int;
+
+        const_iterator(const SuccessorGenerator* generator,
+                       const StateWord* words, int node_idx)
+            : generator(generator), words(words), node_idx(node_idx), pos(0) {
+            if (node_idx < generator->num_nodes()) {
+                pos = generator->nodes[node_idx].ops_begin;
+                skip_empty_nodes();
+            }
+        }
+
+        int operator*() const { return generator->leaf_operators[pos]; }
+
+        const_iterator& operator++() {
+            pos++;
+            skip_empty_nodes();
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator tmp = *this;
+            ++(*this);
+            return tmp;
+        }
+
+        bool operator==(const const_iterator& other) const {
+            return node_idx == other.node_idx && pos == other.pos;
+        }
+        bool operator!=(const const_iterator& other) const {
+            return !(*this == other);
+        }
+
+       private:
+        const SuccessorGenerator* generator;
+        const StateWord* words;
+        int node_idx;
+        int pos;
+
+        void skip_empty_nodes() {
+            const std::vector<Node>& nodes = generator->nodes;
+            int num_nodes = generator->num_nodes();
+            while (node_idx < num_nodes && pos == nodes[node_idx].ops_end) {
+                node_idx = generator->next_node(node_idx, words);
+                pos = node_idx < num_nodes ? nodes[node_idx].ops_begin : 0;
+            }
+        }
+    };
+
+    class ApplicableOperators {
+        // A lazily evaluated range of the operators applicable in a state
+       public:
+        ApplicableOperators(const SuccessorGenerator* generator,
+                            const StateWord* words)
+            : generator(generator), words(words) {}
+        const_iterator begin() const {
+            return const_iterator(generator, words, 0);
+        }
+        const_iterator end() const {
+            return const_iterator(generator, words, generator->num_nodes());
+        }
+
+       private:
+        const SuccessorGenerator* generator;
+        const StateWord* words;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<int> leaf_operators;
+
+    SuccessorGenerator() {}
+
+    SuccessorGenerator(const OperatorTable& operators) {
+        std::vector<int> ops(operators.size());
+        for (int op = 0; op < operators.size(); op++) {
+            ops[op] = op;
+        }
+        build(operators, ops, 0);
+    }
+
+    int num_nodes() const { return (int)nodes.size(); }
+
+    ApplicableOperators applicable(const PackedState& state) const {
+        return ApplicableOperators(this, state.data());
+    }
+
+    void generate_applicable_ops(const PackedState& state,
+                                 std::vector<int>& result) const {
+        result.clear();
+        int node_idx = 0;
+        while (node_idx < num_nodes()) {
+            const Node& node = nodes[node_idx];
+            result.insert(result.end(), leaf_operators.begin() + node.ops_begin,
+                          leaf_operators.begin() + node.ops_end);
+            node_idx = next_node(node_idx, state.data());
+        }
+    }
+
+   private:
+    int next_node(int node_idx, const StateWord* words) const {
+        const Node& node = nodes[node_idx];
+        if (node.fact >= 0 &&
+            ((words[node.fact / STATE_WORD_BITS] >>
+              (node.fact % STATE_WORD_BITS)) &
+             1)) {
+            return node_idx + 1;
+        }
+        return node.skip;
+    }
+
+    void build(const OperatorTable& operators, std::vector<int>& ops,
+               int depth) {
+        /*
+        Append the subtree for "ops", whose first "depth" preconditions have
+        already been tested on the path from the root. Operators that do not
+        need the tested fact are handled by the next node of the loop, so
+        only the true subtrees are built recursively.
+        */
+        bool first = true;
+        while (!ops.empty()) {
+            int node_idx = (int)nodes.size();
+            nodes.push_back({-1, node_idx + 1, (int)leaf_operators.size(),
+                             (int)leaf_operators.size()});
+            std::vector<int> remaining;
+            if (first) {
+                for (int op : ops) {
+                    if (operators.preconditions(op).size() == depth) {
+                        leaf_operators.push_back(op);
+                    } else {
+                        remaining.push_back(op);
+                    }
+                }
+                nodes[node_idx].ops_end = (int)leaf_operators.size();
+                first = false;
+            } else {
+                remaining.swap(ops);
+            }
+            if (remaining.empty()) {
+                break;
+            }
+
+            int fact = operators.preconditions(remaining[0])[depth];
+            for (int op : remaining) {
+                fact = std::min(fact, operators.preconditions(op)[depth]);
+            }
+            std::vector<int> true_ops;
+            ops.clear();
+            for (int op : remaining) {
+                if (operators.preconditions(op)[depth] == fact) {
+                    true_ops.push_back(op);
+                } else {
+                    ops.push_back(op);
+                }
+            }
+            nodes[node_idx].fact = fact;
+            build(operators, true_ops, depth + 1);
+            nodes[node_idx].skip = (int)nodes.size();
+        }
+    }
+};
@@ -0,0 +1,225 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "parallel_hashmap/phmap.h"
+
+using phmap::flat_hash_map;
+using phmap::flat_hash_set;
+
+class SymbolTable {
+    /*
+    Assigns the dense ids 0, 1, 2, ... to names in the order in which they
+    are interned, so that the rest of the pipeline can refer to a name by
+    an int and only needs the string to print it.
+    */
+   public:
+    // The id of "name", which gets the next free id if it is new
+    int intern(const std::string& name) {
+        auto [it, inserted] = ids.emplace(name, (int)names.size());
+        if (inserted) {
+            names.push_back(name);
+        }
+        return it->second;
+    }
+
+    // The id of "name", -1 if it was never interned
+    int find(const std::string& name) const {
+        auto it = ids.find(name);
+        return it == ids.end() ? -1 : it->second;
+    }
+
+    const std::string& name(int id) const { return names[id]; }
+
+    int size() const { return (int)names.size(); }
+
+   private:
+    std::vector<std::string> names;
+    flat_hash_map<std::string, int> ids;
+};
+
+// The names of a task: every predicate, object, type and action by its id
+struct Symbols {
+    SymbolTable predicates;
+    SymbolTable objects;
+    SymbolTable types;
+    SymbolTable actions;
+};
+
+class GroundAtomTable {
+    /*
+    Interns ground atoms, i.e. a symbol (a predicate, or an action for an
+    operator) with a tuple of objects, as dense ids. The tuples are stored
+    back to back in one array, so a table of many atoms makes a handful of
+    allocations instead of one string per atom, and an atom is compared and
+    hashed as a few ints.
+
+    find() does not change the table, so several threads can look atoms up
+    while no atom is inserted.
+    */
+   public:
+    GroundAtomTable() : table(0, IdHash(this), IdEqual(this)) {}
+
+    // The hash set refers to its table, so a copy rebuilds its own set
+    GroundAtomTable(const GroundAtomTable& other)
+        : data(other.data),
+          offsets(other.offsets),
+          hashes(other.hashes),
+          table(0, IdHash(this), IdEqual(this)) {
+        rebuild();
+    }
+
+    GroundAtomTable(GroundAtomTable&& other)
+        : data(std::move(other.data)),
+          offsets(std::move(other.offsets)),
+          hashes(std::move(other.hashes)),
+          table(0, IdHash(this), IdEqual(this)) {
+        rebuild();
+        other.clear();
+    }
+
+    GroundAtomTable& operator=(GroundAtomTable other) {
+        data = std::move(other.data);
+        offsets = std::move(other.offsets);
+        hashes = std::move(other.hashes);
+        table = Table(0, IdHash(this), IdEqual(this));
+        rebuild();
+        other.clear();
+        return *this;
+    }
+
+    /*
+    Intern the atom "symbol(args[0], ..., args[arity - 1])".
+    @return The id of the atom and True if it is new, False otherwise
+    */
+    std::pair<int, bool> insert(int symbol, const int* args, int arity) {
+        Key key{symbol, args, arity, hash(symbol, args, arity)};
+        auto it = table.find(key);
+        if (it != table.end()) {
+            return std::make_pair(*it, false);
+        }
+        int id = size();
+        data.push_back(symbol);
+        data.insert(data.end(), args, args + arity);
+        offsets.push_back((int)data.size());
+        hashes.push_back(key.hash);
+        table.insert(id);
+        return std::make_pair(id, true);
+    }
+
+    std::pair<int, bool> insert(int symbol, const std::vector<int>& args) {
+        return insert(symbol, args.data(), (int)args.size());
+    }
+
+    // The id of the atom, -1 if it was never interned
+    int find(int symbol, const int* args, int arity) const {
+        Key key{symbol, args, arity, hash(symbol, args, arity)};
+        auto it = table.find(key);
+        return it == table.end() ? -1 : *it;
+    }
+
+    int find(int symbol, const std::vector<int>& args) const {
+        return find(symbol, args.data(), (int)args.size());
+    }
+
+    int symbol(int id) const { return data[offsets[id]]; }
+
+    // The objects of the atom "id", arity(id) of them
+    const int* args(int id) const { return data.data() + offsets[id] + 1; }
+
+    int arity(int id) const { return offsets[id + 1] - offsets[id] - 1; }
+
+    int size() const { return (int)hashes.size(); }
+
+    // The atom as a string such as "(at truck1 locA )"
+    std::string name(int id, const SymbolTable& symbols,
+                     const SymbolTable& objects) const {
+        std::string name = "(" + symbols.name(symbol(id));
+        if (arity(id) > 0) {
+            name += " ";
+            for (int i = 0; i < arity(id); i++) {
+                name += objects.name(args(id)[i]) + " ";
+            }
+        }
+        return name + ")";
+    }
+
+   private:
+    // An atom that is not necessarily in the table
+    struct Key {
+        int symbol;
+        const int* args;
+        int arity;
+        size_t hash;
+    };
+
+    struct IdHash {
+        using is_transparent = void;
+        const GroundAtomTable* atoms;
+        IdHash(const GroundAtomTable* atoms) : atoms(atoms) {}
+        size_t operator()(int id) const { return atoms->hashes[id]; }
+        size_t operator()(const Key& key) const { return key.hash; }
+    };
+
+    struct IdEqual {
+        using is_transparent = void;
+        const GroundAtomTable* atoms;
+        IdEqual(const GroundAtomTable* atoms) : atoms(atoms) {}
+        bool operator()(int lhs, int rhs) const {
+            return atoms->equal(lhs, atoms->symbol(rhs), atoms->args(rhs),
+                                atoms->arity(rhs));
+        }
+        bool operator()(int lhs, const Key& rhs) const {
+            return atoms->equal(lhs, rhs.symbol, rhs.args, rhs.arity);
+        }
+        bool operator()(const Key& lhs, int rhs) const {
+            return atoms->equal(rhs, lhs.symbol, lhs.args, lhs.arity);
+        }
+    };
+
+    typedef flat_hash_set<int, IdHash, IdEqual> Table;
+
+    std::vector<int> data;  // per atom its symbol and its objects
+    std::vector<int> offsets = {0};
+    std::vector<size_t> hashes;
+    Table table;
+
+    static size_t hash(int symbol, const int* args, int arity) {
+        size_t seed = std::hash<int>()(symbol);
+        for (int i = 0; i < arity; i++) {
+            seed ^= std::hash<int>()(args[i]) + 0x9e3779b9 + (seed << 6) +
+                    (seed >> 2);
+        }
+        return seed;
+    }
+
+    bool equal(int id, int symbol, const int* args, int arity) const {
+        if (this->symbol(id) != symbol || this->arity(id) != arity) {
+            return false;
+        }
+        const int* own = this->args(id);
+        for (int i = 0; i < arity; i++) {
+            if (own[i] != args[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void clear() {
+        table.clear();
+        data.clear();
+        offsets.assign(1, 0);
+        hashes.clear();
+    }
+
+    void rebuild() {
+        table.reserve(hashes.size());
+        for (int id = 0; id < size(); id++) {
+            table.insert(id);
+        }
+    }
+};
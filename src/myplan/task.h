@@ -1,4 +1,5 @@
 #pragma once
+#include <algorithm>
 #include <any>
 //#include <flat_hash_set>
 #include <functional>
@@ -8,8 +9,12 @@
 #include <string>
 #include <vector>
 
+#include "operator_table.h"
 #include "parallel_hashmap/phmap.h"
-#include "settrie.h"
+#include "state.h"
+#include "successor_generator.h"
+#include "symbols.h"
+#include "variables.h"
 
 using namespace std;
 using phmap::flat_hash_map;
@@ -124,40 +129,6 @@ class EncodedOperator {
         return true;
     }
 
-    pair<size_t, flat_hash_set<int>> apply(const flat_hash_set<int>& state,
-                                           size_t hash_val) {
-        // assert(applicable(state));
-        flat_hash_set<int> new_state = state;
-        for (const int& fact : del_effects) {
-            if (new_state.erase(fact)) {
-                hash_val ^= std::hash<std::string>{}(std::to_string(fact));
-            }
-        }
-        for (const int& fact : add_effects) {
-            if (new_state.insert(fact).second) {
-                hash_val ^= std::hash<std::string>{}(std::to_string(fact));
-            }
-        }
-        return make_pair(hash_val, new_state);
-    }
-
-    void apply(const flat_hash_set<int>& state,
-               pair<size_t, flat_hash_set<int>>& result, size_t hash_val) {
-        // assert(applicable(state));
-        result.second = state;
-        for (const int fact : del_effects_vec) {
-            if (result.second.erase(fact)) {
-                hash_val ^= std::hash<std::string>{}(std::to_string(fact));
-            }
-        }
-        for (const int fact : add_effects_vec) {
-            if (result.second.insert(fact).second) {
-                hash_val ^= std::hash<std::string>{}(std::to_string(fact));
-            }
-        }
-        result.first = hash_val;
-    }
-
     bool operator==(const EncodedOperator& other) const {
         return (name == other.name) && (preconditions == other.preconditions) &&
                (add_effects == other.add_effects) &&
@@ -165,6 +136,22 @@ class EncodedOperator {
     }
 };
 
+// The rows of "table" as stand-alone operators
+inline std::vector<EncodedOperator> to_encoded_operators(
+    const OperatorTable& table) {
+    std::vector<EncodedOperator> operators;
+    for (int op = 0; op < table.size(); op++) {
+        FactRange pre = table.preconditions(op);
+        FactRange add = table.add_effects(op);
+        FactRange del = table.del_effects(op);
+        std::vector<int> pre_vec(pre.begin(), pre.end());
+        std::vector<int> add_vec(add.begin(), add.end());
+        std::vector<int> del_vec(del.begin(), del.end());
+        operators.emplace_back(table.names[op], pre_vec, add_vec, del_vec);
+    }
+    return operators;
+}
+
 namespace std {
 template <>
 struct hash<flat_hash_set<std::string>> {
@@ -214,16 +201,52 @@ class BaseTask {
     flat_hash_set<int> facts;
     flat_hash_set<int> initial_state;
     flat_hash_set<int> goals;
-    std::vector<EncodedOperator> operators;
-    std::unordered_map<std::string, int> encoding_map;
-    std::unordered_map<int, std::string> reverse_encoding_map;
-    std::unordered_map<int, std::string> action_id2name;
+    OperatorTable operators;
+    // the names of the task; a fact id is the id of its atom in
+    // "fact_atoms", and an operator named n is the atom
+    // n - first_operator_name of "operator_atoms", whose symbol is an action
+    Symbols symbols;
+    GroundAtomTable fact_atoms;
+    GroundAtomTable operator_atoms;
+    int first_operator_name = 0;
+    int num_state_words = 0;
+    std::vector<uint64_t> zobrist_keys;
+    // finite-domain variables of the facts, empty if none were synthesized
+    VariableLayout variables;
+
+    // The name of the fact "fact", such as "(at truck1 locA )"
+    std::string fact_name(int fact) const {
+        return fact_atoms.name(fact, symbols.predicates, symbols.objects);
+    }
+
+    // The name of the operator named "name", such as "(drive truck1 locA )"
+    std::string operator_name(int name) const {
+        return operator_atoms.name(name - first_operator_name,
+                                   symbols.actions, symbols.objects);
+    }
+
+    PackedState get_initial_state() const {
+        return PackedState(initial_state, num_state_words);
+    }
+
+    void initialize_zobrist_keys() {
+        // one key for every bit of the packed states
+        zobrist_keys = make_zobrist_keys(num_state_words * STATE_WORD_BITS);
+    }
 
-    virtual bool goal_reached(flat_hash_set<int>& state) = 0;
+    size_t hash_state(const PackedState& state) const {
+        size_t hash_val = 0;
+        for (int w = 0; w < state.num_words(); w++) {
+            hash_val =
+                toggle_zobrist_hash(hash_val, w, state.words[w], zobrist_keys);
+        }
+        return hash_val;
+    }
+
+    virtual bool goal_reached(const PackedState& state) = 0;
     virtual void get_successor_states(
-        flat_hash_set<int>& state,
-        std::vector<std::pair<int, pair<size_t, flat_hash_set<int>>>>&
-            successors,
+        const PackedState& state,
+        std::vector<std::pair<int, pair<size_t, PackedState>>>& successors,
         size_t hash_val) = 0;
 };
 
@@ -232,61 +255,101 @@ class Task : public BaseTask {
     A STRIPS planning task
     */
    public:
-    SetTrie<int, EncodedOperator*> settrie;
+    SuccessorGenerator successor_generator;
+    FactMask goal_mask;
 
     Task() {}
     Task(std::string name, flat_hash_set<int>& facts,
          flat_hash_set<int>& initial_state, flat_hash_set<int>& goals,
-         std::vector<EncodedOperator> operators)
-        : settrie(SetTrie<int, EncodedOperator*>()) {
+         std::vector<EncodedOperator> operators) {
         this->name = name;
         this->facts = facts;
         this->initial_state = initial_state;
         this->goals = goals;
-        this->operators = operators;
-        initialize_settrie();
-    }
-
-    void initialize_settrie() {
         for (EncodedOperator& op : operators) {
-            settrie.assign(op.preconditions, &op);
+            this->operators.add_operator(op.name, op.preconditions_vec,
+                                         op.add_effects_vec,
+                                         op.del_effects_vec);
         }
+        initialize_successor_generator();
+        initialize_state_layout();
+    }
+
+    Task(std::string name, flat_hash_set<int>& facts,
+         flat_hash_set<int>& initial_state, flat_hash_set<int>& goals,
+         OperatorTable operators) {
+        this->name = name;
+        this->facts = facts;
+        this->initial_state = initial_state;
+        this->goals = goals;
+        this->operators = std::move(operators);
+        initialize_successor_generator();
+        initialize_state_layout();
     }
 
-    bool goal_reached(flat_hash_set<int>& state) override {
+    void initialize_successor_generator() {
+        successor_generator = SuccessorGenerator(operators);
+    }
+
+    void initialize_state_layout() {
+        /*
+        Every fact id gets one bit of the packed states, so the width is
+        determined by the largest id that appears anywhere in the task.
+        */
+        int num_bits = 0;
+        auto update = [&num_bits](int fact) {
+            num_bits = std::max(num_bits, fact + 1);
+        };
+        std::for_each(facts.begin(), facts.end(), update);
+        std::for_each(initial_state.begin(), initial_state.end(), update);
+        std::for_each(goals.begin(), goals.end(), update);
+        std::for_each(operators.pre_facts.begin(), operators.pre_facts.end(),
+                      update);
+        std::for_each(operators.add_facts.begin(), operators.add_facts.end(),
+                      update);
+        std::for_each(operators.del_facts.begin(), operators.del_facts.end(),
+                      update);
+        num_state_words = get_num_state_words(num_bits);
+        initialize_zobrist_keys();
+        goal_mask = FactMask(std::vector<int>(goals.begin(), goals.end()));
+    }
+
+    bool goal_reached(const PackedState& state) override {
         /*
         The goal has been reached if all facts that are true in "goals"
         are true in "state".
         @return True if all the goals are reached, False otherwise
         */
-        for (int g : goals) {
-            if (state.find(g) == state.end()) {
-                return false;
-            }
-        }
-        return true;
-        // return state == goals;
+        return goal_mask.subset_of(state.data());
+    }
+
+    // Indices of the operators applicable in "state"
+    void get_applicable_operators(const PackedState& state,
+                                  std::vector<int>& applicable_operators) {
+        successor_generator.generate_applicable_ops(state,
+                                                    applicable_operators);
     }
 
     void get_successor_states(
-        flat_hash_set<int>& state,
-        std::vector<std::pair<int, pair<size_t, flat_hash_set<int>>>>&
-            successors,
+        const PackedState& state,
+        std::vector<std::pair<int, pair<size_t, PackedState>>>& successors,
         size_t hash_val) override {
         /*
         @return A vector with (op, new_state) pairs where "op" is the applicable
         operator and "new_state" the state that results when "op" is applied
-        in state "state".
+        in state "state". The states already stored in "successors" are
+        overwritten in place so that their buffers are reused.
         */
-        std::set<int> sorted_state(state.begin(), state.end());
-        std::vector<EncodedOperator*> applicable_operators;
-        settrie.subsets(sorted_state, applicable_operators);
-        successors.resize(applicable_operators.size());
         size_t i = 0;
-        for (EncodedOperator* op : applicable_operators) {
-            successors[i].first = op->name;
-            op->apply(state, successors[i].second, hash_val);
+        for (int op_idx : successor_generator.applicable(state)) {
+            if (i == successors.size()) {
+                successors.emplace_back();
+            }
+            successors[i].first = operators.names[op_idx];
+            operators.apply(op_idx, state, successors[i].second, hash_val,
+                            zobrist_keys);
             i++;
         }
+        successors.resize(i);
     }
 };
@@ -0,0 +1,111 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+    /*
+    A fixed set of worker threads for parallel loops. parallel_for() hands
+    out the indices of a loop one at a time to the workers and to the
+    calling thread, which takes part as thread 0, and returns when the
+    whole loop is done. The threads are started once and wait between
+    loops, so a pool can run many short loops.
+
+    A loop body must not throw. With one thread, loops run on the calling
+    thread only.
+    */
+   public:
+    // Use "num_threads" threads, or one per hardware thread if it is 0
+    explicit ThreadPool(unsigned num_threads = 0) {
+        if (num_threads == 0) {
+            num_threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        for (unsigned id = 1; id < num_threads; id++) {
+            workers.emplace_back([this, id] { work(id); });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    // The number of threads, including the calling thread
+    unsigned size() const { return (unsigned)workers.size() + 1; }
+
+    // Call "body(i, thread)" for all 0 <= i < n, "thread" < size()
+    void parallel_for(int n, const std::function<void(int, unsigned)>& body) {
+        if (workers.empty() || n <= 1) {
+            for (int i = 0; i < n; i++) {
+                body(i, 0);
+            }
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            loop_body = &body;
+            loop_size = n;
+            next_index = 0;
+            busy_workers = (unsigned)workers.size();
+            generation++;
+        }
+        wake.notify_all();
+        run_loop(0);
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return busy_workers == 0; });
+        loop_body = nullptr;
+    }
+
+   private:
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    bool stopping = false;
+    unsigned long generation = 0;  // of the current loop
+    unsigned busy_workers = 0;
+
+    const std::function<void(int, unsigned)>* loop_body = nullptr;
+    int loop_size = 0;
+    std::atomic<int> next_index{0};
+
+    void run_loop(unsigned id) {
+        for (int i = next_index++; i < loop_size; i = next_index++) {
+            (*loop_body)(i, id);
+        }
+    }
+
+    void work(unsigned id) {
+        unsigned long seen = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock,
+                          [&] { return stopping || generation != seen; });
+                if (stopping) {
+                    return;
+                }
+                seen = generation;
+            }
+            run_loop(id);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                busy_workers--;
+            }
+            done.notify_one();
+        }
+    }
+};
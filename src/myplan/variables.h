@@ -0,0 +1,128 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "state.h"
+
+class VariableLayout {
+    /*
+    Finite-domain (SAS+) variables over the facts of a task and a compact
+    encoding of states with them.
+
+    Every variable owns a group of facts of which at most one holds in any
+    reachable state. Its values are the indices of its facts, plus the
+    value "none of them" (0, the facts are then 1 .. n) unless exactly one
+    fact always holds. A variable with d values is stored in
+    ceil(log2(d)) bits, and variables never straddle a word boundary, so
+    the packed state of a task whose facts form few large groups is much
+    smaller than its bitset over the facts.
+
+    An empty layout has no variables; its packed state is the fact bitset.
+    */
+   public:
+    struct Variable {
+        std::vector<int> facts;
+        bool has_none = false;
+        int bits = 0;
+        int word = 0;  // the word and the lowest bit of the variable's value
+        int shift = 0;
+    };
+
+    std::vector<Variable> variables;
+    std::vector<int> var_of;    // per fact, -1 if it has no variable
+    std::vector<int> value_of;  // per fact, its value in its variable
+
+    VariableLayout() {}
+
+    VariableLayout(const std::vector<std::vector<int>>& groups,
+                   const std::vector<char>& exactly_one, int num_fact_bits)
+        : var_of(num_fact_bits, -1), value_of(num_fact_bits, 0) {
+        assert(groups.size() == exactly_one.size());
+        for (size_t v = 0; v < groups.size(); v++) {
+            Variable var;
+            var.facts = groups[v];
+            var.has_none = !exactly_one[v];
+            int domain_size = (int)var.facts.size() + var.has_none;
+            var.bits = 0;
+            while ((1 << var.bits) < domain_size) {
+                var.bits++;
+            }
+            for (size_t i = 0; i < var.facts.size(); i++) {
+                var_of[var.facts[i]] = (int)v;
+                value_of[var.facts[i]] = (int)i + var.has_none;
+            }
+            variables.push_back(var);
+        }
+
+        // place the widest variables first, which leaves less padding
+        std::vector<int> order(variables.size());
+        for (size_t v = 0; v < order.size(); v++) {
+            order[v] = (int)v;
+        }
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+            return variables[a].bits > variables[b].bits;
+        });
+        int word = 0;
+        int shift = 0;
+        for (int v : order) {
+            Variable& var = variables[v];
+            if (shift + var.bits > STATE_WORD_BITS) {
+                word++;
+                shift = 0;
+            }
+            var.word = word;
+            var.shift = shift;
+            shift += var.bits;
+        }
+        num_words = variables.empty() ? 0 : word + 1;
+    }
+
+    bool empty() const { return variables.empty(); }
+
+    int size() const { return (int)variables.size(); }
+
+    // The number of words of a packed state
+    int packed_words() const { return num_words; }
+
+    int packed_bits() const {
+        int bits = 0;
+        for (const Variable& var : variables) {
+            bits += var.bits;
+        }
+        return bits;
+    }
+
+    // Encode "state", in which every variable has at most one true fact
+    void pack(const PackedState& state, StateWord* out) const {
+        std::fill(out, out + num_words, 0);
+        for (int fact : state) {
+            int v = var_of[fact];
+            assert(v >= 0);
+            const Variable& var = variables[v];
+            assert(((out[var.word] >> var.shift) &
+                    ((StateWord(1) << var.bits) - 1)) == 0);
+            out[var.word] |= StateWord(value_of[fact]) << var.shift;
+        }
+    }
+
+    // Decode the packed words "in" into "state", which has the fact width
+    void unpack(const StateWord* in, PackedState& state) const {
+        std::fill(state.words.begin(), state.words.end(), 0);
+        for (const Variable& var : variables) {
+            int value = (int)((in[var.word] >> var.shift) &
+                              ((StateWord(1) << var.bits) - 1));
+            if (var.has_none) {
+                if (value > 0) {
+                    state.set(var.facts[value - 1]);
+                }
+            } else {
+                state.set(var.facts[value]);
+            }
+        }
+    }
+
+   private:
+    int num_words = 0;
+};
@@ -11,11 +11,13 @@ class DummyTask : public BaseTask {
         this->name = name;
         this->initial_state = initial_state;
         this->goals = goals;
+        this->num_state_words = 1;
+        initialize_zobrist_keys();
     }
 
-    bool goal_reached(flat_hash_set<int>& state) override {
+    bool goal_reached(const PackedState& state) override {
         for (int g : goals) {
-            if (state.find(g) == state.end()) {
+            if (!state.test(g)) {
                 return false;
             }
         }
@@ -23,10 +25,10 @@ class DummyTask : public BaseTask {
     }
 
     void get_successor_states(
-        flat_hash_set<int>& state,
-        std::vector<std::pair<int, pair<size_t, flat_hash_set<int>>>>&
-            succesors,
+        const PackedState& state,
+        std::vector<std::pair<int, pair<size_t, PackedState>>>& succesors,
         size_t hash_val) override {
+        succesors.clear();
         std::vector<int> emp_vec;
         EncodedOperator* sub1 =
             new EncodedOperator(0, emp_vec, emp_vec, emp_vec);
@@ -36,17 +38,17 @@ class DummyTask : public BaseTask {
             new EncodedOperator(1, emp_vec, emp_vec, emp_vec);
         for (int s : state) {
             if (0 < s) {
-                flat_hash_set<int> tmp_u = {s - 1};
+                PackedState tmp_u({s - 1}, num_state_words);
                 succesors.push_back(
                     std::make_pair(sub1->name, make_pair(s - 1, tmp_u)));
             }
             if (s < 9) {
-                flat_hash_set<int> tmp_u = {s + 2};
+                PackedState tmp_u({s + 2}, num_state_words);
                 succesors.push_back(
                     std::make_pair(add2->name, make_pair(s + 2, tmp_u)));
             }
             if (s < 10) {
-                flat_hash_set<int> tmp_u = {s + 1};
+                PackedState tmp_u({s + 1}, num_state_words);
                 succesors.push_back(
                     std::make_pair(add1->name, make_pair(s + 1, tmp_u)));
             }
@@ -13,6 +13,8 @@
 #include "myplan/pddl/lisp_parser.h"
 #include "myplan/pddl/parser.h"
 #include "myplan/pddl/pddl.h"
+#include "myplan/search/astar.h"
+#include "myplan/search/breadth_first_search.h"
 
 using namespace std;
 
@@ -147,6 +149,129 @@ TEST(grounding, Facts) {
     ASSERT_EQ(test_facts, _collect_facts(ops));
 }
 
+TEST(grounding, AtomIndex) {
+    Symbols symbols;
+    GroundAtomTable atoms;
+    auto atom = [&](const std::string& predicate,
+                    const std::vector<std::string>& args) {
+        std::vector<int> objects;
+        for (const std::string& arg : args) {
+            objects.push_back(symbols.objects.intern(arg));
+        }
+        return atoms.insert(symbols.predicates.intern(predicate), objects)
+            .first;
+    };
+    std::vector<int> init = {atom("at", {"red_car", "freiburg"}),
+                             atom("at", {"blue_truck", "basel"}),
+                             atom("road", {"freiburg", "basel"}),
+                             atom("sunny", {})};
+    int outside = atom("at", {"red_car", "basel"});
+    AtomIndex index(atoms, init);
+    int at = symbols.predicates.find("at");
+    int road = symbols.predicates.find("road");
+    int in = symbols.predicates.intern("in");
+    int red_car = symbols.objects.find("red_car");
+    int freiburg = symbols.objects.find("freiburg");
+    int basel = symbols.objects.find("basel");
+    ASSERT_TRUE(index.contains(init[0]));
+    ASSERT_FALSE(index.contains(outside));
+    ASSERT_TRUE(index.contains(init[3]));
+    ASSERT_EQ(atom("sunny", {}), init[3]);
+    ASSERT_EQ(atoms.name(init[0], symbols.predicates, symbols.objects),
+              "(at red_car freiburg )");
+    ASSERT_EQ(atoms.name(init[3], symbols.predicates, symbols.objects),
+              "(sunny)");
+    ASSERT_TRUE(index.has_argument(at, 0, red_car));
+    ASSERT_TRUE(index.has_argument(at, 1, basel));
+    ASSERT_FALSE(index.has_argument(at, 0, basel));
+    ASSERT_FALSE(index.has_argument(at, 2, basel));
+    ASSERT_TRUE(index.has_argument(road, 1, basel));
+    ASSERT_FALSE(index.has_argument(road, 0, basel));
+    ASSERT_FALSE(index.has_argument(in, 0, red_car));
+    ASSERT_EQ(index.matching(road, 0, freiburg).size(), 1);
+    ASSERT_TRUE(index.matching(road, 0, basel).empty());
+}
+
+TEST(grounding, JoinStaticPreconditions) {
+    Type type_object = Type("object", nullptr);
+    Type type_city = Type("city", &type_object);
+    std::vector<Type*> city = {&type_city};
+    std::unordered_map<std::string, Type*> objects{
+        {"a", &type_city}, {"b", &type_city}, {"c", &type_city}};
+    Predicate at_from("at", {{"?from", city}});
+    Predicate at_to("at", {{"?to", city}});
+    Predicate road("road", {{"?from", city}, {"?to", city}});
+    Predicate toll_free("road", {{"?to", city}, {"c", city}});
+    Action drive = get_action("DRIVE", {{"?from", city}, {"?to", city}},
+                              {at_from, road}, {at_to}, {at_from});
+    Action drive_free =
+        get_action("DRIVE-FREE", {{"?from", city}, {"?to", city}},
+                   {at_from, road, toll_free}, {at_to}, {at_from});
+    std::unordered_map<std::string, std::vector<std::string>> type_map =
+        _create_type_map(objects);
+    flat_hash_set<std::string> init = {"(at a )", "(road a b )",
+                                       "(road b c )", "(road b a )"};
+    std::vector<std::string> statics = {"road"};
+
+    std::set<std::string> names;
+    for (Operator& op : _ground_action(drive, type_map, statics, init)) {
+        names.insert(op.name);
+        ASSERT_EQ(op.preconditions.size(), 1);
+    }
+    ASSERT_EQ(names, std::set<std::string>({"(DRIVE a b )", "(DRIVE b c )",
+                                            "(DRIVE b a )"}));
+
+    // the constant argument of the second road restricts ?to to b
+    std::vector<Operator> free_ops =
+        _ground_action(drive_free, type_map, statics, init);
+    ASSERT_EQ(free_ops.size(), 1);
+    ASSERT_EQ(free_ops[0].name, "(DRIVE-FREE a b )");
+}
+
+TEST(grounding, RelaxedReachability) {
+    Type type_object = Type("object", nullptr);
+    Type type_city = Type("city", &type_object);
+    std::vector<Type*> city = {&type_city};
+    std::unordered_map<std::string, Type*> objects{
+        {"a", &type_city}, {"b", &type_city}, {"c", &type_city}};
+    Predicate at_from("at", {{"?from", city}});
+    Predicate at_to("at", {{"?to", city}});
+    Predicate road("road", {{"?from", city}, {"?to", city}});
+    Predicate visited("visited", {{"?to", city}});
+    Action drive = get_action("DRIVE", {{"?from", city}, {"?to", city}},
+                              {at_from, road}, {at_to, visited}, {at_from});
+    Action wait = get_action("WAIT", {{"?to", city}}, {}, {visited}, {});
+    std::vector<Action> actions = {drive, wait};
+    std::unordered_map<std::string, std::vector<std::string>> type_map =
+        _create_type_map(objects);
+    flat_hash_set<std::string> init = {"(at a )", "(road a b )",
+                                       "(road b a )", "(road c b )"};
+    std::vector<std::string> statics = {"road"};
+
+    // c can never be reached, so the truck never drives from c
+    std::set<std::string> names;
+    for (Operator& op :
+         _ground_reachable_actions(actions, type_map, statics, init)) {
+        names.insert(op.name);
+    }
+    ASSERT_EQ(names, std::set<std::string>({"(DRIVE a b )", "(DRIVE b a )",
+                                            "(WAIT a )", "(WAIT b )",
+                                            "(WAIT c )"}));
+    ASSERT_EQ(_ground_actions(actions, type_map, statics, init).size(), 6);
+
+    // the order of the operators does not depend on the number of threads
+    std::vector<std::string> sequential, parallel;
+    for (Operator& op :
+         _ground_reachable_actions(actions, type_map, statics, init, 1)) {
+        sequential.push_back(op.name);
+    }
+    for (Operator& op :
+         _ground_reachable_actions(actions, type_map, statics, init, 4)) {
+        parallel.push_back(op.name);
+    }
+    ASSERT_EQ(sequential, parallel);
+}
+
 TEST(grounding, GetGroundedString) {
     std::string grounded_string = "(DRIVE-CAR ford freiburg berlin )";
     ASSERT_EQ(_get_grounded_string("DRIVE-CAR", {"ford", "freiburg", "berlin"}),
@@ -365,21 +490,18 @@ TEST(grounding, Operators) {
     task = ground(standard_problem);
 
     for (int var : task.facts) {
-        ASSERT_FALSE(starts_with(task.reverse_encoding_map[var], "car_color"));
+        ASSERT_FALSE(starts_with(task.fact_name(var), "(car_color"));
     }
 
-    for (EncodedOperator op : task.operators) {
+    for (EncodedOperator op : to_encoded_operators(task.operators)) {
         for (int pre : op.preconditions) {
-            ASSERT_FALSE(
-                starts_with(task.reverse_encoding_map[pre], "car_color"));
+            ASSERT_FALSE(starts_with(task.fact_name(pre), "(car_color"));
         }
         for (int add : op.add_effects) {
-            ASSERT_FALSE(
-                starts_with(task.reverse_encoding_map[add], "car_color"));
+            ASSERT_FALSE(starts_with(task.fact_name(add), "(car_color"));
         }
         for (int dee : op.del_effects) {
-            ASSERT_FALSE(
-                starts_with(task.reverse_encoding_map[dee], "car_color"));
+            ASSERT_FALSE(starts_with(task.fact_name(dee), "(car_color"));
         }
     }
 
@@ -455,11 +577,17 @@ TEST(grounding, Operators) {
     Task parsed_task8 = ground(parsed_problem8);
 
     std::vector<std::vector<EncodedOperator>> operators1 = {
-        parsed_task5.operators, parsed_task6.operators, parsed_task5.operators,
-        parsed_task5.operators, parsed_task5.operators};
+        to_encoded_operators(parsed_task5.operators),
+        to_encoded_operators(parsed_task6.operators),
+        to_encoded_operators(parsed_task5.operators),
+        to_encoded_operators(parsed_task5.operators),
+        to_encoded_operators(parsed_task5.operators)};
     std::vector<std::vector<EncodedOperator>> operators2 = {
-        coded_task5.operators, coded_task6.operators, coded_task6.operators,
-        parsed_task7.operators, parsed_task8.operators};
+        to_encoded_operators(coded_task5.operators),
+        to_encoded_operators(coded_task6.operators),
+        to_encoded_operators(coded_task6.operators),
+        to_encoded_operators(parsed_task7.operators),
+        to_encoded_operators(parsed_task8.operators)};
     std::vector<bool> expected_results = {true, true, false, false, true};
 
     for (int i = 0; i < expected_results.size(); i++) {
@@ -525,3 +653,28 @@ TEST(grounding, Operators) {
     }
 }
 
+
+TEST(GroundingTest, KeepStatics) {
+    // "road" is static: with the statics kept in the initial state, they are
+    // part of every search state and need a variable of their own
+    std::string dom =
+        "(define (domain roads) (:requirements :typing) (:predicates (at ?l) "
+        "(road ?from ?to)) (:action move :parameters (?from ?to) "
+        ":precondition (and (at ?from) (road ?from ?to)) :effect (and (at "
+        "?to) (not (at ?from)))))";
+    std::string prob =
+        "(define (problem p) (:domain roads) (:objects a b c) (:init (at a) "
+        "(road a b) (road b c)) (:goal (at c)))";
+    Parser parser = Parser("");
+    Problem problem = parse_problem(parser, dom, prob);
+
+    Task task = ground(problem, false);
+    ASSERT_EQ(task.initial_state.size(), 3);
+    ASSERT_FALSE(task.variables.empty());
+    for (int fact : task.initial_state) {
+        ASSERT_GE(task.variables.var_of[fact], 0);
+    }
+    ASSERT_EQ(breadth_first_search(task).size(), 2);
+    BlindHeuristic heuristic(task);
+    ASSERT_EQ(astar(task, heuristic).size(), 2);
+}
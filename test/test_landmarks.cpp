@@ -11,6 +11,7 @@
 #include <vector>
 
 #include "myplan/heuristic/landmarks.h"
+#include "myplan/search/astar.h"
 #include "myplan/task.h"
 
 using namespace std;
@@ -48,7 +49,7 @@ TEST(LandmarkHeuristic, RelaxedTask) {
     std::vector<EncodedOperator> operators = {op1};
     Task task("task1", v4, v4, v4, operators);
     Task relaxed_task = _get_relaxed_task(task);
-    ASSERT_EQ(relaxed_task.operators[0].del_effects.size(), 0);
+    ASSERT_EQ(relaxed_task.operators.del_effects(0).size(), 0);
 }
 
 TEST(LandmarkHeuristic, LandmarksGoal) {
@@ -101,24 +102,143 @@ TEST(LandmarkHeuristic, Heuristics) {
     Task task4("task4", s_abc, s_a, s_cb, ops4);
 
     LandmarkHeuristic heuristic1(task1);
-    vector<SearchNode> nodes1 = {make_root_node(task1.initial_state)};
+    SearchSpace space1;
+    space1.open_initial(0);
+    heuristic1.initialize(space1);
     flat_hash_set<int> expected_landmark1 = {1, 2};
     flat_hash_map<int, float> expected_lmc1 = {{1, 1}, {2, 1}};
     ASSERT_EQ(get_landmarks(task1), expected_landmark1);
     ASSERT_EQ(compute_landmark_costs(task1, expected_landmark1), expected_lmc1);
-    ASSERT_EQ(heuristic1.calculate_h(0, nodes1), 2);
+    ASSERT_EQ(
+        heuristic1.calculate_h(task1.get_initial_state(), 0, space1),
+        2);
 
     LandmarkHeuristic heuristic2(task2);
-    vector<SearchNode> nodes2 = {make_root_node(task2.initial_state)};
+    SearchSpace space2;
+    space2.open_initial(0);
+    heuristic2.initialize(space2);
     ASSERT_EQ(get_landmarks(task2), expected_landmark1);
     ASSERT_EQ(compute_landmark_costs(task2, expected_landmark1), expected_lmc1);
-    ASSERT_EQ(heuristic2.calculate_h(0, nodes2), 1);
+    ASSERT_EQ(
+        heuristic2.calculate_h(task2.get_initial_state(), 0, space2),
+        1);
 
     LandmarkHeuristic heuristic4(task4);
-    vector<SearchNode> nodes4 = {make_root_node(task4.initial_state)};
+    SearchSpace space4;
+    space4.open_initial(0);
+    heuristic4.initialize(space4);
     flat_hash_set<int> expected_landmark4 = {1, 2};
     flat_hash_map<int, float> expected_lmc4 = {{1, 0.5}, {2, 0.5}};
     ASSERT_EQ(get_landmarks(task4), expected_landmark4);
     ASSERT_EQ(compute_landmark_costs(task4, expected_landmark4), expected_lmc4);
-    ASSERT_EQ(heuristic4.calculate_h(0, nodes4), 1);
+    ASSERT_EQ(
+        heuristic4.calculate_h(task4.get_initial_state(), 0, space4),
+        1);
+}
+
+TEST(LandmarkHeuristic, LandmarkGraph) {
+    // a is reached from x or y, both need s; b needs a; the goals are b, c
+    std::vector<int> v_s = {0}, v_x = {1}, v_y = {2}, v_a = {3}, v_b = {4},
+                     v_c = {5};
+    std::vector<int> v_emp = {};
+    EncodedOperator op_sx(10, v_s, v_x, v_emp);
+    EncodedOperator op_sy(11, v_s, v_y, v_emp);
+    EncodedOperator op_xa(12, v_x, v_a, v_emp);
+    EncodedOperator op_ya(13, v_y, v_a, v_emp);
+    EncodedOperator op_ab(14, v_a, v_b, v_emp);
+    EncodedOperator op_bc(15, v_b, v_c, v_emp);
+    EncodedOperator op_ac(16, v_a, v_c, v_emp);
+    flat_hash_set<int> facts = {0, 1, 2, 3, 4, 5};
+    flat_hash_set<int> init = {0};
+    flat_hash_set<int> goals = {4, 5};
+    Task task("graph", facts, init, goals,
+              {op_sx, op_sy, op_xa, op_ya, op_ab, op_bc, op_ac});
+
+    LandmarkGraph graph = compute_landmark_graph(task);
+    flat_hash_set<int> expected = {3, 4, 5};
+    ASSERT_EQ(get_landmarks(task), expected);
+    ASSERT_EQ(graph.size(), 3);
+    int a = graph.node_of[3], b = graph.node_of[4], c = graph.node_of[5];
+    ASSERT_FALSE(graph.is_goal[a]);
+    ASSERT_TRUE(graph.is_goal[b]);
+    ASSERT_TRUE(graph.is_goal[c]);
+
+    // x and y are alternatives, so a has no parent
+    ASSERT_TRUE(graph.parents[a].empty());
+    ASSERT_EQ(graph.first_achievers[a], std::vector<int>({2, 3}));
+    ASSERT_EQ(graph.parents[b], std::vector<int>({a}));
+    // c is achieved first by bc or ac, which share no precondition
+    ASSERT_EQ(graph.first_achievers[c], std::vector<int>({5, 6}));
+    ASSERT_TRUE(graph.parents[c].empty());
+    ASSERT_EQ(graph.children[a], std::vector<int>({b}));
+}
+
+TEST(LandmarkHeuristic, AcceptedLandmarks) {
+    // a -> b -> c and b -> a, the goals are b and c
+    flat_hash_set<int> s_abc = {0, 1, 2};
+    flat_hash_set<int> s_a = {0};
+    flat_hash_set<int> s_cb = {2, 1};
+    std::vector<int> v_a = {0}, v_b = {1}, v_c = {2};
+    std::vector<int> v_emp = {};
+    EncodedOperator op_ab(4, v_a, v_b, v_emp);
+    EncodedOperator op_bc(5, v_b, v_c, v_emp);
+    EncodedOperator op_ba(6, v_b, v_a, v_emp);
+    Task task("task1", s_abc, s_a, s_cb, {op_ab, op_bc, op_ba});
+
+    LandmarkHeuristic heuristic(task);
+    SearchSpace space;
+    heuristic.initialize(space);
+    space.open_initial(0);
+    ASSERT_EQ(heuristic.calculate_h(task.get_initial_state(), 0, space), 2);
+
+    // b is accepted when op_ab adds it
+    space.open(1, 0, 4);
+    PackedState s_ab({0, 1}, task.num_state_words);
+    ASSERT_EQ(heuristic.calculate_h(s_ab, 1, space), 1);
+    // it stays accepted, an operator that adds nothing new changes nothing
+    space.open(2, 1, 6);
+    ASSERT_EQ(heuristic.calculate_h(s_ab, 2, space), 1);
+    // c is accepted, but the goal b is required again once it is deleted
+    space.open(3, 2, 5);
+    PackedState s_c({2}, task.num_state_words);
+    ASSERT_EQ(heuristic.calculate_h(s_c, 3, space), 1);
+    PackedState s_bc({1, 2}, task.num_state_words);
+    ASSERT_EQ(heuristic.calculate_h(s_bc, 3, space), 0);
+}
+
+TEST(LandmarkHeuristic, OptimalCostPartitioning) {
+    // o1 adds p and q, o2 adds q and r, o3 adds r; the goals are p, q, r
+    std::vector<int> v_p = {0}, v_q = {1}, v_r = {2};
+    std::vector<int> v_pq = {0, 1}, v_qr = {1, 2};
+    std::vector<int> v_emp = {};
+    EncodedOperator op1(4, v_emp, v_pq, v_emp);
+    EncodedOperator op2(5, v_emp, v_qr, v_emp);
+    EncodedOperator op3(6, v_emp, v_r, v_emp);
+    flat_hash_set<int> facts = {0, 1, 2};
+    flat_hash_set<int> init = {};
+    flat_hash_set<int> goals = {0, 1, 2};
+    Task task("ocp", facts, init, goals, {op1, op2, op3});
+
+    // the uniform partitioning gives every landmark 1/2
+    LandmarkHeuristic uniform(task);
+    SearchSpace space1;
+    uniform.initialize(space1);
+    space1.open_initial(0);
+    ASSERT_FLOAT_EQ(uniform.calculate_h(task.get_initial_state(), 0, space1),
+                    1.5);
+
+    // p and r are worth 1 each if q gets nothing
+    OptimalLandmarkHeuristic optimal(task);
+    SearchSpace space2;
+    optimal.initialize(space2);
+    space2.open_initial(0);
+    ASSERT_NEAR(optimal.calculate_h(task.get_initial_state(), 0, space2), 2,
+                1e-5);
+
+    // after o1 only r is needed
+    space2.open(1, 0, 4);
+    PackedState s_pq({0, 1}, task.num_state_words);
+    ASSERT_NEAR(optimal.calculate_h(s_pq, 1, space2), 1, 1e-5);
+    // an optimal plan never costs less than the heuristic value
+    ASSERT_EQ(astar(task, optimal).size(), 2);
 }
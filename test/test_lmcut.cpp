@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <vector>
+
+#include "myplan/heuristic/lmcut.h"
+#include "myplan/heuristic/relaxation.h"
+#include "myplan/search/astar.h"
+#include "myplan/task.h"
+
+// a -> b -> c and a -> d, the goals are c and d; e is a detour back to a
+Task get_lmcut_chain_task() {
+    std::vector<int> v_a = {0}, v_b = {1}, v_c = {2}, v_d = {3}, v_e = {4};
+    std::vector<int> v_emp = {};
+    EncodedOperator op_ab(10, v_a, v_b, v_emp);
+    EncodedOperator op_bc(11, v_b, v_c, v_emp);
+    EncodedOperator op_ad(12, v_a, v_d, v_emp);
+    EncodedOperator op_ae(13, v_a, v_e, v_emp);
+    EncodedOperator op_ea(14, v_e, v_a, v_emp);
+    flat_hash_set<int> facts = {0, 1, 2, 3, 4};
+    flat_hash_set<int> init = {0};
+    flat_hash_set<int> goals = {2, 3};
+    return Task("chain", facts, init, goals,
+                {op_ab, op_bc, op_ad, op_ae, op_ea});
+}
+
+TEST(LmCutHeuristic, Values) {
+    Task task = get_lmcut_chain_task();
+    SearchSpace space;
+    LmCutHeuristic lmcut(task);
+    hMaxHeuristic hmax(task);
+    PackedState init = task.get_initial_state();
+    // {bc}, {ab} and {ad} are disjoint landmarks
+    ASSERT_EQ(hmax.calculate_h(init, 0, space), 2);
+    ASSERT_EQ(lmcut.calculate_h(init, 0, space), 3);
+    ASSERT_FALSE(lmcut.supports_preferred_operators());
+
+    // the arrays are reused by the next evaluation
+    PackedState state({0, 1, 3}, task.num_state_words);
+    ASSERT_EQ(lmcut.calculate_h(state, 0, space), 1);
+    PackedState goal({2, 3}, task.num_state_words);
+    ASSERT_EQ(lmcut.calculate_h(goal, 0, space), 0);
+    ASSERT_EQ(lmcut.calculate_h(init, 0, space), 3);
+}
+
+TEST(LmCutHeuristic, IncrementalUpdate) {
+    // g needs p and q, which are both reached from a; p also from a -> x
+    std::vector<int> v_a = {0}, v_p = {1}, v_q = {2}, v_g = {3}, v_x = {4};
+    std::vector<int> v_pq = {1, 2};
+    std::vector<int> v_emp = {};
+    EncodedOperator op_ap(10, v_a, v_p, v_emp);
+    EncodedOperator op_aq(11, v_a, v_q, v_emp);
+    EncodedOperator op_ax(12, v_a, v_x, v_emp);
+    EncodedOperator op_xp(13, v_x, v_p, v_emp);
+    EncodedOperator op_pqg(14, v_pq, v_g, v_emp);
+    flat_hash_set<int> facts = {0, 1, 2, 3, 4};
+    flat_hash_set<int> init = {0};
+    flat_hash_set<int> goals = {3};
+    Task task("join", facts, init, goals,
+              {op_ap, op_aq, op_ax, op_xp, op_pqg});
+
+    SearchSpace space;
+    LmCutHeuristic lmcut(task);
+    hMaxHeuristic hmax(task);
+    PackedState state = task.get_initial_state();
+    ASSERT_EQ(hmax.calculate_h(state, 0, space), 2);
+    ASSERT_EQ(lmcut.calculate_h(state, 0, space), 3);
+}
+
+TEST(LmCutHeuristic, OperatorsWithoutPreconditions) {
+    std::vector<int> v_a = {0}, v_b = {1};
+    std::vector<int> v_emp = {};
+    EncodedOperator op_a(10, v_emp, v_a, v_emp);
+    EncodedOperator op_ab(11, v_a, v_b, v_emp);
+    flat_hash_set<int> facts = {0, 1};
+    flat_hash_set<int> init = {};
+    flat_hash_set<int> goals = {1};
+    Task task("free", facts, init, goals, {op_a, op_ab});
+
+    SearchSpace space;
+    LmCutHeuristic lmcut(task);
+    ASSERT_EQ(lmcut.calculate_h(task.get_initial_state(), 0, space), 2);
+}
+
+TEST(LmCutHeuristic, DeadEnd) {
+    Task task = get_lmcut_chain_task();
+    SearchSpace space;
+    LmCutHeuristic lmcut(task);
+    PackedState state({1}, task.num_state_words);
+    ASSERT_GE(lmcut.calculate_h(state, 0, space),
+              std::numeric_limits<float>::max());
+}
+
+TEST(LmCutHeuristic, OptimalSearch) {
+    Task task = get_lmcut_chain_task();
+    LmCutHeuristic lmcut(task);
+    ASSERT_EQ(astar(task, lmcut).size(), 3);
+}
@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <vector>
+
+#include "myplan/search/open_list.h"
+
+TEST(BucketOpenList, OrderedByKeys) {
+    BucketOpenList<int> open_list;
+    open_list.push(3, 1, 0);
+    open_list.push(2, 2, 1);
+    open_list.push(2, 0, 2);
+    open_list.push(5, 0, 3);
+    ASSERT_EQ(open_list.size(), 4);
+    ASSERT_EQ(open_list.min_primary_key(), 2);
+    ASSERT_EQ(open_list.pop(), 2);
+    ASSERT_EQ(open_list.pop(), 1);
+    ASSERT_EQ(open_list.pop(), 0);
+
+    // a smaller key than the last popped one is still returned first
+    open_list.push(1, 4, 4);
+    ASSERT_EQ(open_list.pop(), 4);
+    ASSERT_EQ(open_list.pop(), 3);
+    ASSERT_TRUE(open_list.empty());
+}
+
+TEST(BucketOpenList, TieBreaking) {
+    BucketOpenList<int> fifo(TieBreaking::FIFO);
+    BucketOpenList<int> lifo(TieBreaking::LIFO);
+    for (int i = 0; i < 4; i++) {
+        fifo.push(1, 1, i);
+        lifo.push(1, 1, i);
+    }
+    std::vector<int> fifo_order, lifo_order;
+    while (!fifo.empty()) {
+        fifo_order.push_back(fifo.pop());
+        lifo_order.push_back(lifo.pop());
+    }
+    ASSERT_EQ(fifo_order, std::vector<int>({0, 1, 2, 3}));
+    ASSERT_EQ(lifo_order, std::vector<int>({3, 2, 1, 0}));
+
+    // emptied buckets are reusable
+    fifo.push(1, 1, 7);
+    fifo.push(0, 3, 8);
+    ASSERT_EQ(fifo.pop(), 8);
+    ASSERT_EQ(fifo.pop(), 7);
+}
+
+TEST(BucketOpenList, BucketKeys) {
+    ASSERT_EQ(to_bucket_key(0), 0);
+    ASSERT_EQ(to_bucket_key(3), 3);
+    ASSERT_EQ(to_bucket_key(2.5), 3);
+    ASSERT_EQ(to_bucket_key(1.0f / 3 + 1.0f / 3 + 1.0f / 3), 1);
+    ASSERT_EQ(to_bucket_key(std::numeric_limits<float>::max()), DEAD_END);
+    ASSERT_EQ(to_bucket_key(std::numeric_limits<float>::infinity()),
+              DEAD_END);
+}
+
+TEST(AlternationOpenList, Boosting) {
+    AlternationOpenList<int> open_list(TieBreaking::FIFO, 3);
+    for (int i = 0; i < 4; i++) {
+        open_list.push(i, 0, i);
+    }
+    open_list.push(5, 0, 10, true);
+    open_list.push(6, 0, 11, true);
+    ASSERT_EQ(open_list.size(), 8);
+
+    // the queues take turns
+    ASSERT_EQ(open_list.pop(), 10);
+    ASSERT_EQ(open_list.pop(), 0);
+    ASSERT_EQ(open_list.pop(), 11);
+    ASSERT_EQ(open_list.pop(), 1);
+
+    // after a boost the preferred queue is used until it is empty
+    open_list.push(7, 0, 12, true);
+    open_list.push(8, 0, 13, true);
+    open_list.boost_preferred();
+    ASSERT_EQ(open_list.pop(), 12);
+    ASSERT_EQ(open_list.pop(), 13);
+    ASSERT_EQ(open_list.pop(), 2);
+}
@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <vector>
+
+#include "myplan/heuristic/pdb.h"
+#include "myplan/search/astar.h"
+#include "myplan/task.h"
+
+// a -> b -> c, b is deleted by b -> c; x -> y independently
+Task get_pdb_task() {
+    std::vector<int> v_a = {0}, v_b = {1}, v_c = {2}, v_x = {3}, v_y = {4};
+    std::vector<int> v_emp = {};
+    EncodedOperator op_ab(10, v_a, v_b, v_a);
+    EncodedOperator op_bc(11, v_b, v_c, v_b);
+    EncodedOperator op_xy(12, v_x, v_y, v_x);
+    flat_hash_set<int> facts = {0, 1, 2, 3, 4};
+    flat_hash_set<int> init = {0, 3};
+    flat_hash_set<int> goals = {2, 4};
+    return Task("pdb", facts, init, goals, {op_ab, op_bc, op_xy});
+}
+
+TEST(PatternDatabase, Distances) {
+    Task task = get_pdb_task();
+    std::vector<int> goals = {2, 4};
+    PatternDatabase pdb(task.operators, goals, {2, 1, 0});
+    ASSERT_EQ(pdb.size(), 8);
+    ASSERT_EQ(pdb.get_pattern(), std::vector<int>({0, 1, 2}));
+    PackedState init = task.get_initial_state();
+    ASSERT_EQ(pdb.lookup(init), 2);
+    ASSERT_EQ(pdb.lookup(PackedState({1}, task.num_state_words)), 1);
+    ASSERT_EQ(pdb.lookup(PackedState({2}, task.num_state_words)), 0);
+    ASSERT_EQ(pdb.lookup(PackedState({}, task.num_state_words)), PDB_INF);
+
+    // facts outside the pattern do not matter
+    PatternDatabase pdb_c(task.operators, goals, {2});
+    ASSERT_EQ(pdb_c.lookup(init), 1);
+}
+
+TEST(PatternDatabase, SelectPatterns) {
+    Task task = get_pdb_task();
+    std::vector<std::vector<int>> patterns = select_goal_patterns(task, 8);
+    ASSERT_EQ(patterns, std::vector<std::vector<int>>({{0, 1, 2}, {3, 4}}));
+    patterns = select_goal_patterns(task, 2);
+    ASSERT_EQ(patterns, std::vector<std::vector<int>>({{1, 2}, {3, 4}}));
+}
+
+TEST(PatternDatabase, CanonicalHeuristic) {
+    Task task = get_pdb_task();
+    SearchSpace space;
+    PackedState init = task.get_initial_state();
+
+    // the patterns do not share operators and are added
+    PDBHeuristic additive(task, {{0, 1, 2}, {3, 4}});
+    ASSERT_EQ(additive.cliques.size(), 1);
+    ASSERT_EQ(additive.calculate_h(init, 0, space), 3);
+
+    // op_bc changes both {1, 2} and {0, 1}, so only the maximum is used
+    PDBHeuristic overlapping(task, {{1, 2}, {0, 1}, {3, 4}});
+    ASSERT_EQ(overlapping.cliques.size(), 2);
+    ASSERT_EQ(overlapping.calculate_h(init, 0, space), 3);
+
+    PackedState dead_end({3}, task.num_state_words);
+    ASSERT_GE(additive.calculate_h(dead_end, 0, space),
+              std::numeric_limits<float>::max());
+}
+
+TEST(PatternDatabase, OptimalSearch) {
+    Task task = get_pdb_task();
+    PDBHeuristic pdb(task);
+    ASSERT_EQ(astar(task, pdb).size(), 3);
+}
@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "myplan/heuristic/relaxation.h"
+#include "myplan/task.h"
+
+// a -> b -> c and a -> d, the goals are c and d; e is a detour to c
+Task get_chain_task() {
+    std::vector<int> v_a = {0}, v_b = {1}, v_c = {2}, v_d = {3}, v_e = {4};
+    std::vector<int> v_emp = {};
+    EncodedOperator op_ab(10, v_a, v_b, v_emp);
+    EncodedOperator op_bc(11, v_b, v_c, v_emp);
+    EncodedOperator op_ad(12, v_a, v_d, v_emp);
+    EncodedOperator op_ae(13, v_a, v_e, v_emp);
+    EncodedOperator op_ec(14, v_e, v_a, v_emp);
+    flat_hash_set<int> facts = {0, 1, 2, 3, 4};
+    flat_hash_set<int> init = {0};
+    flat_hash_set<int> goals = {2, 3};
+    return Task("chain", facts, init, goals,
+                {op_ab, op_bc, op_ad, op_ae, op_ec});
+}
+
+TEST(RelaxationHeuristic, Values) {
+    Task task = get_chain_task();
+    SearchSpace space;
+    hAddHeuristic hadd(task);
+    hMaxHeuristic hmax(task);
+    hFFHeuristic hff(task);
+    PackedState init = task.get_initial_state();
+    ASSERT_EQ(hadd.calculate_h(init, 0, space), 3);
+    ASSERT_EQ(hmax.calculate_h(init, 0, space), 2);
+    ASSERT_EQ(hff.calculate_h(init, 0, space), 3);
+    ASSERT_TRUE(hadd.preferred_operators.empty());
+}
+
+TEST(RelaxationHeuristic, PreferredOperators) {
+    Task task = get_chain_task();
+    SearchSpace space;
+    hAddHeuristic hadd(task);
+    ASSERT_TRUE(hadd.supports_preferred_operators());
+    hadd.compute_preferred_operators = true;
+
+    // the relaxed plan is {ab, bc, ad}; ab and ad are applicable
+    PackedState init = task.get_initial_state();
+    hadd.calculate_h(init, 0, space);
+    std::vector<int> preferred = hadd.preferred_operators;
+    std::sort(preferred.begin(), preferred.end());
+    ASSERT_EQ(preferred, std::vector<int>({10, 12}));
+
+    PackedState state({0, 1, 3}, task.num_state_words);
+    hadd.calculate_h(state, 0, space);
+    ASSERT_EQ(hadd.preferred_operators, std::vector<int>({11}));
+}
+
+TEST(RelaxationHeuristic, FFCountsSharedOperatorsOnce) {
+    // both goals need b, which is reached by one operator
+    std::vector<int> v_a = {0}, v_b = {1}, v_c = {2}, v_d = {3};
+    std::vector<int> v_emp = {};
+    EncodedOperator op_ab(10, v_a, v_b, v_emp);
+    EncodedOperator op_bc(11, v_b, v_c, v_emp);
+    EncodedOperator op_bd(12, v_b, v_d, v_emp);
+    flat_hash_set<int> facts = {0, 1, 2, 3};
+    flat_hash_set<int> init = {0};
+    flat_hash_set<int> goals = {2, 3};
+    Task task("shared", facts, init, goals, {op_ab, op_bc, op_bd});
+
+    SearchSpace space;
+    hAddHeuristic hadd(task);
+    hFFHeuristic hff(task);
+    PackedState state = task.get_initial_state();
+    ASSERT_EQ(hadd.calculate_h(state, 0, space), 4);
+    ASSERT_EQ(hff.calculate_h(state, 0, space), 3);
+    ASSERT_TRUE(hff.preferred_operators.empty());
+
+    hff.compute_preferred_operators = true;
+    hff.calculate_h(state, 0, space);
+    ASSERT_EQ(hff.preferred_operators, std::vector<int>({10}));
+
+    // unreachable goals stay infinite
+    PackedState empty(task.num_state_words);
+    ASSERT_GE(hff.calculate_h(empty, 0, space),
+              std::numeric_limits<float>::max());
+}
+
+TEST(RelaxationHeuristic, Queue) {
+    RelaxedQueue queue(4);
+    queue.push(1, 10);
+    queue.push(0, 11);
+    queue.push(7, 12);
+    queue.push(1, 13);
+    queue.push(5, 14);
+    ASSERT_EQ(queue.pop(), std::make_pair(0, 11));
+    ASSERT_EQ(queue.pop(), std::make_pair(1, 10));
+    queue.push(2, 15);
+    ASSERT_EQ(queue.pop(), std::make_pair(1, 13));
+    ASSERT_EQ(queue.pop(), std::make_pair(2, 15));
+    // distances beyond the buckets come from the heap
+    ASSERT_EQ(queue.pop(), std::make_pair(5, 14));
+    ASSERT_EQ(queue.pop(), std::make_pair(7, 12));
+    ASSERT_TRUE(queue.empty());
+
+    queue.push(3, 16);
+    queue.clear();
+    ASSERT_TRUE(queue.empty());
+    queue.push(0, 17);
+    ASSERT_EQ(queue.pop(), std::make_pair(0, 17));
+}
+
+TEST(RelaxationHeuristic, OperatorsWithoutPreconditions) {
+    std::vector<int> v_a = {0}, v_b = {1};
+    std::vector<int> v_emp = {};
+    EncodedOperator op_a(10, v_emp, v_a, v_emp);
+    EncodedOperator op_ab(11, v_a, v_b, v_emp);
+    flat_hash_set<int> facts = {0, 1};
+    flat_hash_set<int> init = {};
+    flat_hash_set<int> goals = {1};
+    Task task("free", facts, init, goals, {op_a, op_ab});
+
+    SearchSpace space;
+    hAddHeuristic hadd(task);
+    hMaxHeuristic hmax(task);
+    PackedState state = task.get_initial_state();
+    ASSERT_EQ(hadd.calculate_h(state, 0, space), 2);
+    ASSERT_EQ(hmax.calculate_h(state, 0, space), 2);
+}
+
+TEST(RelaxationHeuristic, BoundedHMax) {
+    Task task = get_chain_task();
+    SearchSpace space;
+    hMaxHeuristic hmax(task);
+    PackedState init = task.get_initial_state();
+    bool exact;
+    ASSERT_EQ(hmax.calculate_h_bounded(init, 0, space, 2, exact), 2);
+    ASSERT_TRUE(exact);
+    // c is only settled at distance 2, so the exploration stops there
+    ASSERT_EQ(hmax.calculate_h_bounded(init, 0, space, 1, exact), 2);
+    ASSERT_FALSE(exact);
+    ASSERT_EQ(hmax.calculate_h_bounded(init, 0, space, 0, exact), 1);
+    ASSERT_FALSE(exact);
+
+    // heuristics without bound support are always exact
+    hAddHeuristic hadd(task);
+    ASSERT_EQ(hadd.calculate_h_bounded(init, 0, space, 0, exact), 3);
+    ASSERT_TRUE(exact);
+}
+
+TEST(RelaxationHeuristic, StopsAtLastGoal) {
+    // a -> b -> c -> x, the goal is b
+    std::vector<int> v_a = {0}, v_b = {1}, v_c = {2}, v_x = {3};
+    std::vector<int> v_emp = {};
+    EncodedOperator op_ab(10, v_a, v_b, v_emp);
+    EncodedOperator op_bc(11, v_b, v_c, v_emp);
+    EncodedOperator op_cx(12, v_c, v_x, v_emp);
+    flat_hash_set<int> facts = {0, 1, 2, 3};
+    flat_hash_set<int> init = {0};
+    flat_hash_set<int> goals = {1};
+    Task task("far", facts, init, goals, {op_ab, op_bc, op_cx});
+
+    SearchSpace space;
+    hAddHeuristic hadd(task);
+    ASSERT_EQ(hadd.calculate_h(task.get_initial_state(), 0, space), 1);
+    // x is farther than the goal and is never reached
+    ASSERT_EQ(hadd.distance[3], RELAXED_INF);
+}
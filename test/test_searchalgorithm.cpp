@@ -1,11 +1,33 @@
 #include <gtest/gtest.h>
 
+#include <cstdlib>
 #include <string>
 #include <unordered_set>
 #include <vector>
 
 #include "dummy_task.h"
+#include "myplan/heuristic/base.h"
+#include "myplan/search/astar.h"
 #include "myplan/search/breadth_first_search.h"
+#include "myplan/search/greedy_best_first_search.h"
+#include "myplan/search/lazy_search.h"
+
+struct ZeroHeuristic : Heuristic {
+    float calculate_h(const PackedState& state, StateID id,
+                      SearchSpace& space) {
+        return 0;
+    }
+};
+
+// The distance between the single fact of the state and the single goal
+struct DistanceHeuristic : Heuristic {
+    int goal;
+    DistanceHeuristic(int goal) : goal(goal) {}
+    float calculate_h(const PackedState& state, StateID id,
+                      SearchSpace& space) {
+        return (float)std::abs(goal - *state.begin());
+    }
+};
 
 TEST(breadth_first, SearchAtGoal) {
     DummyTask task = get_search_space_at_goal();
@@ -30,3 +52,88 @@ TEST(breadth_first, SearchFourStep) {
     std::vector<int> solution = breadth_first_search(task);
     ASSERT_EQ(solution.size(), 4);
 }
+
+TEST(astar, SearchThreeStep) {
+    DummyTask task = get_simple_search_space();
+    ZeroHeuristic heuristic;
+    ASSERT_EQ(astar(task, heuristic).size(), 3);
+    ASSERT_EQ(astar(task, heuristic, TieBreaking::FIFO).size(), 3);
+}
+
+TEST(astar, SearchFourStep) {
+    DummyTask task = get_simple_search_space2();
+    ZeroHeuristic heuristic;
+    ASSERT_EQ(astar(task, heuristic).size(), 4);
+    ASSERT_EQ(astar(task, heuristic, TieBreaking::FIFO).size(), 4);
+}
+
+TEST(astar, SearchNoSolution) {
+    DummyTask task = get_search_no_solution();
+    ZeroHeuristic heuristic;
+    ASSERT_EQ(astar(task, heuristic).size(), 0);
+}
+
+TEST(greedy_best_first, Search) {
+    DummyTask task = get_simple_search_space();
+    DistanceHeuristic heuristic(10);
+    ASSERT_EQ(greedy_best_first_search(task, heuristic).size(), 3);
+
+    DummyTask task2 = get_simple_search_space2();
+    ZeroHeuristic zero;
+    ASSERT_EQ(greedy_best_first_search(task2, zero).size(), 4);
+
+    DummyTask task3 = get_search_space_at_goal();
+    ASSERT_EQ(greedy_best_first_search(task3, zero).size(), 0);
+
+    DummyTask task4 = get_search_no_solution();
+    ASSERT_EQ(greedy_best_first_search(task4, zero).size(), 0);
+}
+
+TEST(weighted_astar, Search) {
+    DummyTask task = get_simple_search_space();
+    DistanceHeuristic heuristic(10);
+    ASSERT_EQ(weighted_astar(task, heuristic, 1).size(), 3);
+    ASSERT_EQ(weighted_astar(task, heuristic, 3).size(), 3);
+
+    DummyTask task2 = get_simple_search_space2();
+    DistanceHeuristic heuristic2(1);
+    ASSERT_EQ(weighted_astar(task2, heuristic2, 2).size(), 4);
+}
+
+TEST(lazy_search, Search) {
+    DummyTask task = get_simple_search_space();
+    DistanceHeuristic heuristic(10);
+    ASSERT_EQ(lazy_greedy_best_first_search(task, heuristic).size(), 3);
+    ASSERT_EQ(lazy_weighted_astar(task, heuristic, 1).size(), 3);
+    ASSERT_EQ(lazy_weighted_astar(task, heuristic, 4).size(), 3);
+
+    DummyTask task2 = get_simple_search_space2();
+    ZeroHeuristic zero;
+    ASSERT_EQ(lazy_greedy_best_first_search(task2, zero).size(), 4);
+    ASSERT_EQ(lazy_weighted_astar(task2, zero, 2).size(), 4);
+
+    DummyTask task3 = get_search_space_at_goal();
+    ASSERT_EQ(lazy_greedy_best_first_search(task3, zero).size(), 0);
+
+    DummyTask task4 = get_search_no_solution();
+    ASSERT_EQ(lazy_weighted_astar(task4, zero, 2).size(), 0);
+}
+
+TEST(greedy_best_first, PreferredOperators) {
+    // the heuristic reports no preferred operators, so the regular queue
+    // alone has to find the plans
+    DummyTask task = get_simple_search_space();
+    DistanceHeuristic heuristic(10);
+    ASSERT_EQ(greedy_best_first_search(task, heuristic, true).size(), 3);
+    ASSERT_EQ(lazy_greedy_best_first_search(task, heuristic, true).size(), 3);
+    ASSERT_EQ(lazy_weighted_astar(task, heuristic, 2, true).size(), 3);
+}
+
+TEST(astar, CostBound) {
+    DummyTask task = get_simple_search_space();
+    ZeroHeuristic heuristic;
+    ASSERT_EQ(astar(task, heuristic, TieBreaking::LIFO, 3).size(), 3);
+    ASSERT_EQ(astar(task, heuristic, TieBreaking::LIFO, 2).size(), 0);
+    ASSERT_EQ(weighted_astar(task, heuristic, 2, TieBreaking::LIFO, 3).size(),
+              3);
+}
@@ -6,48 +6,94 @@
 
 #include "myplan/search/searchspace.h"
 
-flat_hash_set<int> state1 = {1};
-flat_hash_set<int> state2 = {2};
-flat_hash_set<int> state3 = {3};
-flat_hash_set<int> state4 = {4};
-flat_hash_set<int> state5 = {5};
-SearchNode root = make_root_node(state1);
-SearchNode child1 = make_child_node(0, root.g, 6, state2, root.hash_value);
-SearchNode child2 = make_child_node(0, root.g, 7, state3, root.hash_value);
-SearchNode grandchild1 =
-    make_child_node(1, child1.g, 8, state4, child1.hash_value);
-SearchNode grandchild2 =
-    make_child_node(2, child2.g, 9, state5, child2.hash_value);
+PackedState state1({1}, 1);
+PackedState state2({2}, 1);
+PackedState state3({3}, 1);
+PackedState state4({4}, 1);
+PackedState state5({5}, 1);
+StateRegistry registry(1);
+StateID id1 = registry.insert_state(state1, 1).first;
+StateID id2 = registry.insert_state(state2, 2).first;
+StateID id3 = registry.insert_state(state3, 3).first;
+StateID id4 = registry.insert_state(state4, 4).first;
+StateID id5 = registry.insert_state(state5, 5).first;
 
 TEST(searchspace, ExtractSolution) {
-    std::vector<SearchNode> nodes = {root, child1, child2, grandchild1,
-                                     grandchild2};
+    SearchSpace space;
+    space.open_initial(id1);
+    space.open(id2, id1, 6);
+    space.open(id3, id1, 7);
+    space.open(id4, id2, 8);
+    space.open(id5, id3, 9);
     std::vector<int> solution_0;
-    solution_0 = extract_solution(0, nodes);
+    solution_0 = space.extract_solution(id1);
     ASSERT_EQ(solution_0.size(), 0);
     std::vector<int> test1 = {6, 8};
     std::vector<int> test2 = {7, 9};
     std::vector<int> solution_1, solution_2;
-    solution_1 = extract_solution(3, nodes);
-    solution_2 = extract_solution(4, nodes);
+    solution_1 = space.extract_solution(id4);
+    solution_2 = space.extract_solution(id5);
     ASSERT_EQ(solution_1, test1);
     ASSERT_EQ(solution_2, test2);
+
+    // reaching a state again overwrites its record
+    space.open(id5, id4, 10);
+    ASSERT_EQ(space.extract_solution(id5), std::vector<int>({6, 8, 10}));
+    ASSERT_EQ(space[id5].g, 3);
+}
+
+TEST(searchspace, GValuesAndStatus) {
+    SearchSpace space;
+    ASSERT_EQ(space[id3].status, NodeStatus::NEW);
+    space.open_initial(id1);
+    space.open(id2, id1, 6);
+    space.open(id4, id2, 8);
+    ASSERT_EQ(space[id1].g, 0);
+    ASSERT_EQ(space[id2].g, 1);
+    ASSERT_EQ(space[id4].g, 2);
+    ASSERT_EQ(space[id4].status, NodeStatus::OPEN);
+    space.close(id1);
+    space.mark_dead_end(id4);
+    ASSERT_EQ(space[id1].status, NodeStatus::CLOSED);
+    ASSERT_EQ(space[id4].status, NodeStatus::DEAD_END);
+    ASSERT_EQ(sizeof(SearchNodeInfo), 16);
 }
 
-TEST(searchspace, GValues) {
-    ASSERT_EQ(root.g, 0);
-    ASSERT_EQ(child1.g, 1);
-    ASSERT_EQ(grandchild2.g, 2);
+TEST(searchspace, PerStateTables) {
+    SearchSpace space;
+    PerStateTable<int>& table = space.register_table<int>(-1);
+    ASSERT_EQ(table[id3], -1);
+    table[id3] = 5;
+    int& entry = table[id3];
+    for (StateID id = 0; id < 100000; id++) {
+        table[id]++;
+    }
+    // entries are never relocated
+    ASSERT_EQ(&entry, &table[id3]);
+    ASSERT_EQ(table[id3], 6);
+    ASSERT_EQ(table[99999], 0);
+}
+
+TEST(searchspace, SegmentedVector) {
+    SegmentedVector<int, 2> vec(7);
+    for (int i = 0; i < 10; i++) {
+        vec.push_back(i);
+    }
+    ASSERT_EQ(vec.size(), 10);
+    ASSERT_EQ(vec[9], 9);
+    vec.resize(13);
+    ASSERT_EQ(vec.size(), 13);
+    ASSERT_EQ(vec[12], 7);
 }
 
 TEST(searchspace, States) {
-    for (int s : root.state) {
+    for (int s : registry.get_state(id1)) {
         ASSERT_EQ(s, 1);
     }
-    for (int s : child2.state) {
+    for (int s : registry.get_state(id3)) {
         ASSERT_EQ(s, 3);
     }
-    for (int s : grandchild1.state) {
+    for (int s : registry.get_state(id4)) {
         ASSERT_EQ(s, 4);
     }
 }
@@ -0,0 +1,46 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "myplan/simplex.h"
+
+TEST(SimplexSolver, Optimal) {
+    // max 3x + 2y  s.t.  x + y <= 4,  x + 3y <= 6,  x <= 3
+    SimplexSolver solver(2, {1, 1, 1, 3, 1, 0}, {4, 6, 3});
+    ASSERT_EQ(solver.solve({3, 2}), LPStatus::OPTIMAL);
+    ASSERT_NEAR(solver.objective_value(), 11, 1e-9);
+    std::vector<double> x = solver.solution();
+    ASSERT_NEAR(x[0], 3, 1e-9);
+    ASSERT_NEAR(x[1], 1, 1e-9);
+}
+
+TEST(SimplexSolver, WarmStart) {
+    SimplexSolver solver(2, {1, 1, 1, 3, 1, 0}, {4, 6, 3});
+    ASSERT_EQ(solver.solve({3, 2}), LPStatus::OPTIMAL);
+    // a new objective starts from the previous basis
+    ASSERT_EQ(solver.solve({0, 1}), LPStatus::OPTIMAL);
+    ASSERT_NEAR(solver.objective_value(), 2, 1e-9);
+    ASSERT_EQ(solver.solve({0, 0}), LPStatus::OPTIMAL);
+    ASSERT_NEAR(solver.objective_value(), 0, 1e-9);
+    ASSERT_EQ(solver.solve({1, 1}), LPStatus::OPTIMAL);
+    ASSERT_NEAR(solver.objective_value(), 4, 1e-9);
+    solver.reset();
+    ASSERT_EQ(solver.solve({1, 1}), LPStatus::OPTIMAL);
+    ASSERT_NEAR(solver.objective_value(), 4, 1e-9);
+}
+
+TEST(SimplexSolver, Degenerate) {
+    // several constraints are tight at the origin
+    SimplexSolver solver(3, {1, -1, 0, 0, 1, -1, -1, 0, 1, 1, 1, 1},
+                         {0, 0, 0, 3});
+    ASSERT_EQ(solver.solve({1, 1, 1}), LPStatus::OPTIMAL);
+    ASSERT_NEAR(solver.objective_value(), 3, 1e-9);
+}
+
+TEST(SimplexSolver, Unbounded) {
+    // y does not appear in any constraint
+    SimplexSolver solver(2, {1, 0}, {1});
+    ASSERT_EQ(solver.solve({1, 0}), LPStatus::OPTIMAL);
+    ASSERT_NEAR(solver.objective_value(), 1, 1e-9);
+    ASSERT_EQ(solver.solve({1, 1}), LPStatus::UNBOUNDED);
+}
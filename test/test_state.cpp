@@ -0,0 +1,45 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "myplan/state.h"
+
+TEST(PackedState, SetTestReset) {
+    PackedState state(2);
+    ASSERT_EQ(state.size(), 0);
+    state.set(0);
+    state.set(63);
+    state.set(64);
+    state.set(127);
+    ASSERT_TRUE(state.test(0));
+    ASSERT_TRUE(state.test(63));
+    ASSERT_TRUE(state.test(64));
+    ASSERT_TRUE(state.test(127));
+    ASSERT_FALSE(state.test(1));
+    ASSERT_EQ(state.size(), 4);
+    state.reset(63);
+    ASSERT_FALSE(state.test(63));
+    ASSERT_EQ(state.size(), 3);
+}
+
+TEST(PackedState, Iteration) {
+    flat_hash_set<int> facts = {3, 64, 100, 191};
+    PackedState state(facts, 3);
+    std::vector<int> iterated(state.begin(), state.end());
+    std::vector<int> expected = {3, 64, 100, 191};
+    ASSERT_EQ(iterated, expected);
+    ASSERT_EQ(state.to_set(), facts);
+
+    PackedState empty(3);
+    ASSERT_TRUE(empty.begin() == empty.end());
+}
+
+TEST(FactMask, SubsetOf) {
+    FactMask mask({2, 65, 66});
+    ASSERT_EQ(mask.entries.size(), 2);
+    PackedState state({2, 65, 66, 70}, 2);
+    ASSERT_TRUE(mask.subset_of(state.data()));
+    state.reset(66);
+    ASSERT_FALSE(mask.subset_of(state.data()));
+    ASSERT_TRUE(FactMask().subset_of(state.data()));
+}
@@ -0,0 +1,45 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "myplan/search/state_registry.h"
+
+TEST(StateRegistry, DenseIds) {
+    StateRegistry registry(2);
+    PackedState s1({1, 70}, 2);
+    PackedState s2({2}, 2);
+    auto [id1, new1] = registry.insert_state(s1, 11);
+    auto [id2, new2] = registry.insert_state(s2, 22);
+    auto [id3, new3] = registry.insert_state(s1, 11);
+    ASSERT_EQ(id1, 0);
+    ASSERT_EQ(id2, 1);
+    ASSERT_EQ(id3, id1);
+    ASSERT_TRUE(new1);
+    ASSERT_TRUE(new2);
+    ASSERT_FALSE(new3);
+    ASSERT_EQ(registry.size(), 2);
+    ASSERT_EQ(registry.get_state(id1), s1);
+    ASSERT_EQ(registry.get_state(id2), s2);
+    ASSERT_EQ(registry.get_hash(id2), 22);
+}
+
+TEST(StateRegistry, HashCollisionsAreNotMerged) {
+    StateRegistry registry(1);
+    std::vector<StateID> ids;
+    for (int i = 0; i < 64; i++) {
+        PackedState state({i}, 1);
+        auto [id, is_new] = registry.insert_state(state, 42);
+        ASSERT_TRUE(is_new);
+        ids.push_back(id);
+    }
+    ASSERT_EQ(registry.size(), 64);
+    for (int i = 0; i < 64; i++) {
+        PackedState state({i}, 1);
+        auto [id, is_new] = registry.insert_state(state, 42);
+        ASSERT_FALSE(is_new);
+        ASSERT_EQ(id, ids[i]);
+        PackedState unpacked;
+        registry.unpack(id, unpacked);
+        ASSERT_EQ(unpacked, state);
+    }
+}
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "myplan/successor_generator.h"
+
+OperatorTable make_operators(std::vector<std::vector<int>> preconditions) {
+    OperatorTable operators;
+    for (size_t i = 0; i < preconditions.size(); i++) {
+        operators.add_operator(i, preconditions[i], {}, {});
+    }
+    return operators;
+}
+
+TEST(SuccessorGenerator, Simple) {
+    std::vector<std::vector<int>> preconditions = {
+        {1}, {1, 2}, {2, 3}, {}, {3, 1}, {70}};
+    SuccessorGenerator generator(make_operators(preconditions));
+
+    std::vector<int> result;
+    generator.generate_applicable_ops(PackedState({1, 3}, 2), result);
+    std::sort(result.begin(), result.end());
+    ASSERT_EQ(result, std::vector<int>({0, 3, 4}));
+
+    generator.generate_applicable_ops(PackedState({2, 70}, 2), result);
+    std::sort(result.begin(), result.end());
+    ASSERT_EQ(result, std::vector<int>({3, 5}));
+
+    generator.generate_applicable_ops(PackedState(2), result);
+    ASSERT_EQ(result, std::vector<int>({3}));
+}
+
+TEST(SuccessorGenerator, Empty) {
+    SuccessorGenerator generator(make_operators({}));
+    PackedState state({0, 1}, 1);
+    auto range = generator.applicable(state);
+    ASSERT_TRUE(range.begin() == range.end());
+}
+
+TEST(SuccessorGenerator, MatchesBruteForce) {
+    std::mt19937 rng(7);
+    int num_facts = 150;
+    std::vector<std::vector<int>> preconditions(300);
+    for (auto& pre : preconditions) {
+        int size = rng() % 5;
+        for (int i = 0; i < size; i++) {
+            pre.push_back(rng() % num_facts);
+        }
+    }
+    SuccessorGenerator generator(make_operators(preconditions));
+
+    int num_words = get_num_state_words(num_facts);
+    for (int trial = 0; trial < 100; trial++) {
+        PackedState state(num_words);
+        for (int f = 0; f < num_facts; f++) {
+            if (rng() % 3 != 0) {
+                state.set(f);
+            }
+        }
+        std::vector<int> expected;
+        for (size_t i = 0; i < preconditions.size(); i++) {
+            if (std::all_of(preconditions[i].begin(), preconditions[i].end(),
+                            [&state](int f) { return state.test(f); })) {
+                expected.push_back(i);
+            }
+        }
+
+        std::vector<int> result;
+        generator.generate_applicable_ops(state, result);
+        std::vector<int> lazy;
+        for (int op : generator.applicable(state)) {
+            lazy.push_back(op);
+        }
+        ASSERT_EQ(lazy, result);
+        std::sort(result.begin(), result.end());
+        ASSERT_EQ(result, expected);
+    }
+}
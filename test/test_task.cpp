@@ -18,7 +18,7 @@ TEST(EncodedOperatorTest, Applicable) {
     ASSERT_TRUE(op1.applicable(s3));
 }
 
-TEST(EncodedOperatorTest, Application) {
+TEST(OperatorTableTest, AddAndDelete) {
     flat_hash_set<int> s1 = {1};
     flat_hash_set<int> s2 = {2};
     flat_hash_set<int> s3 = {1, 2};
@@ -26,10 +26,19 @@ TEST(EncodedOperatorTest, Application) {
     std::vector<int> v2 = {2};
     std::vector<int> v3 = {};
     std::vector<int> v4 = {2};
-    EncodedOperator op1(4, v1, v2, v3);
-    EncodedOperator op4(4, v1, v2, v4);
-    ASSERT_EQ(op1.apply(s1, 1).second, s3);
-    ASSERT_EQ(op4.apply(s1, 1).second, s3);
+    OperatorTable operators;
+    operators.add_operator(4, v1, v2, v3);
+    operators.add_operator(4, v1, v2, v4);
+    std::vector<uint64_t> keys = make_zobrist_keys(64);
+    PackedState state(s1, 1);
+    pair<size_t, PackedState> result;
+    operators.apply(0, state, result, keys[1], keys);
+    ASSERT_EQ(result.second.to_set(), s3);
+    ASSERT_EQ(result.first, keys[1] ^ keys[2]);
+    // a fact that is added and deleted is added
+    operators.apply(1, state, result, keys[1], keys);
+    ASSERT_EQ(result.second.to_set(), s3);
+    ASSERT_EQ(result.first, keys[1] ^ keys[2]);
 }
 
 TEST(EncodedOperatorTest, Successors) {
@@ -52,19 +61,85 @@ TEST(EncodedOperatorTest, Successors) {
 
     std::vector<std::pair<EncodedOperator*, flat_hash_set<int>>> test_ss = {
         {&op1, {1, 2}}, {&op2, {1}}};
-    std::vector<std::pair<int, pair<size_t, flat_hash_set<int>>>> ss;
-    task1.get_successor_states(init, ss, 1);
+    std::vector<std::pair<int, pair<size_t, PackedState>>> ss;
+    PackedState packed_init = task1.get_initial_state();
+    task1.get_successor_states(packed_init, ss, 1);
     ASSERT_EQ(ss[0].first, test_ss[0].first->name);
     ASSERT_EQ(ss[1].first, test_ss[1].first->name);
-    ASSERT_EQ(ss[0].second.second, test_ss[0].second);
-    ASSERT_EQ(ss[1].second.second, test_ss[1].second);
-    flat_hash_set<int> test_v3 = {3};
-    ss.clear();
+    ASSERT_EQ(ss[0].second.second.to_set(), test_ss[0].second);
+    ASSERT_EQ(ss[1].second.second.to_set(), test_ss[1].second);
+    PackedState test_v3({3}, task1.num_state_words);
     task1.get_successor_states(test_v3, ss, 0);
     ASSERT_EQ(ss.size(), 0);
 
-    ASSERT_FALSE(task1.goal_reached(init));
-    flat_hash_set<int> test_goal = {1, 2};
+    ASSERT_FALSE(task1.goal_reached(packed_init));
+    PackedState test_goal({1, 2}, task1.num_state_words);
     ASSERT_TRUE(task1.goal_reached(test_goal));
 }
 
+
+TEST(OperatorTableTest, Layout) {
+    OperatorTable operators;
+    operators.add_operator(4, {3, 1, 3}, {2}, {});
+    operators.add_operator(5, {}, {7, 6}, {1}, 3);
+    ASSERT_EQ(operators.size(), 2);
+    ASSERT_EQ(operators.names, std::vector<int>({4, 5}));
+    ASSERT_EQ(operators.costs, std::vector<int>({1, 3}));
+    ASSERT_EQ(operators.pre_offsets, std::vector<int>({0, 2, 2}));
+    ASSERT_EQ(operators.pre_facts, std::vector<int>({1, 3}));
+    ASSERT_EQ(operators.add_facts, std::vector<int>({2, 6, 7}));
+    ASSERT_TRUE(operators.preconditions(1).empty());
+    ASSERT_EQ(operators.add_effects(1).size(), 2);
+    ASSERT_EQ(operators.del_effects(1)[0], 1);
+
+    OperatorTable relaxed = operators.relaxed();
+    ASSERT_EQ(relaxed.size(), 2);
+    ASSERT_TRUE(relaxed.del_effects(0).empty());
+    ASSERT_TRUE(relaxed.del_effects(1).empty());
+    ASSERT_EQ(relaxed.add_facts, operators.add_facts);
+
+    std::vector<EncodedOperator> encoded = to_encoded_operators(operators);
+    ASSERT_EQ(encoded.size(), 2);
+    ASSERT_EQ(encoded[1].name, 5);
+    ASSERT_EQ(encoded[0].preconditions, std::set<int>({1, 3}));
+    ASSERT_EQ(encoded[1].del_effects, std::set<int>({1}));
+}
+
+TEST(OperatorTableTest, Application) {
+    OperatorTable operators;
+    operators.add_operator(4, {1}, {2}, {});
+    operators.add_operator(5, {1}, {70, 130}, {1, 64});
+    ASSERT_TRUE(operators.applicable(0, PackedState({1}, 1)));
+    ASSERT_FALSE(operators.applicable(0, PackedState({2}, 1)));
+    ASSERT_TRUE(operators.applicable(0, PackedState({1, 2}, 1)));
+
+    // Packed states spanning several words
+    PackedState p1({1, 64, 65}, 3);
+    pair<size_t, PackedState> result;
+    std::vector<uint64_t> keys = make_zobrist_keys(192);
+    operators.apply(1, p1, result, 0, keys);
+    flat_hash_set<int> expected = {65, 70, 130};
+    ASSERT_EQ(result.second.to_set(), expected);
+    ASSERT_EQ(result.second.num_words(), 3);
+    ASSERT_EQ(result.first, keys[1] ^ keys[64] ^ keys[70] ^ keys[130]);
+}
+
+TEST(OperatorTableTest, IncrementalHash) {
+    std::vector<int> v1 = {1};
+    std::vector<int> v2 = {2, 3};
+    std::vector<int> v3 = {1, 5};
+    EncodedOperator op(6, v1, v2, v3);
+    flat_hash_set<int> facts = {1, 2, 3, 4, 5};
+    flat_hash_set<int> init = {1, 3, 4};
+    flat_hash_set<int> goals = {2};
+    Task task("task", facts, init, goals, {op});
+
+    // only the facts whose truth value changes contribute to the update
+    PackedState state = task.get_initial_state();
+    pair<size_t, PackedState> result;
+    task.operators.apply(0, state, result, task.hash_state(state),
+                         task.zobrist_keys);
+    ASSERT_EQ(result.second.to_set(), flat_hash_set<int>({2, 3, 4}));
+    ASSERT_EQ(result.first, task.hash_state(result.second));
+    ASSERT_NE(result.first, task.hash_state(state));
+}
@@ -0,0 +1,38 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <vector>
+
+#include "myplan/thread_pool.h"
+
+TEST(ThreadPool, VisitsEveryIndexOnce) {
+    ThreadPool pool(4);
+    ASSERT_EQ(pool.size(), 4);
+    std::vector<int> visits(1000, 0);
+    std::atomic<bool> valid_threads{true};
+    for (int loop = 0; loop < 20; loop++) {
+        pool.parallel_for((int)visits.size(), [&](int i, unsigned thread) {
+            visits[i]++;
+            if (thread >= 4) {
+                valid_threads = false;
+            }
+        });
+    }
+    for (int count : visits) {
+        ASSERT_EQ(count, 20);
+    }
+    ASSERT_TRUE(valid_threads);
+}
+
+TEST(ThreadPool, SingleThread) {
+    ThreadPool pool(1);
+    ASSERT_EQ(pool.size(), 1);
+    std::vector<int> order;
+    pool.parallel_for(5, [&](int i, unsigned thread) {
+        ASSERT_EQ(thread, 0);
+        order.push_back(i);
+    });
+    ASSERT_EQ(order, std::vector<int>({0, 1, 2, 3, 4}));
+    pool.parallel_for(0, [&](int, unsigned) { order.clear(); });
+    ASSERT_EQ(order.size(), 5);
+}
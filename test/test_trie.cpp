@@ -68,3 +68,34 @@ TEST(settrie, KeyIsStringAndValueIsOperation) {
     std::vector<Operator*> groundtruth_3 = {};
     ASSERT_EQ(result_3, groundtruth_3);
 }
+
+TEST(settrie, CopyAndMove) {
+    SetTrie<int, int> st;
+    st.assign({1, 2}, 0);
+    st.assign({1, 3}, 1);
+    st.assign({4}, 2);
+    ASSERT_EQ(st.size(), 5);  // root, 1, 2, 3 and 4
+
+    SetTrie<int, int> copied = st;
+    copied.assign({1, 2, 5}, 3);
+    std::set<int> query = {1, 2, 3, 4, 5};
+    ASSERT_EQ(st.subsets(query), std::vector<int>({0, 1, 2}));
+    ASSERT_EQ(copied.subsets(query), std::vector<int>({0, 3, 1, 2}));
+
+    SetTrie<int, int> moved = std::move(copied);
+    ASSERT_EQ(moved.subsets(query), std::vector<int>({0, 3, 1, 2}));
+}
+
+TEST(settrie, ManyChildren) {
+    SetTrie<int, int> st;
+    for (int i = 99; i >= 0; i--) {
+        st.assign({i, i + 200}, i);
+    }
+    std::set<int> query_1 = {3, 203, 50};
+    ASSERT_EQ(st.subsets(query_1), std::vector<int>({3}));
+    std::set<int> query_2;
+    for (int i = 0; i < 300; i++) {
+        query_2.insert(i);
+    }
+    ASSERT_EQ(st.subsets(query_2).size(), 100);
+}
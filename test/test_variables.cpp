@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "myplan/mutex_groups.h"
+#include "myplan/search/state_registry.h"
+#include "myplan/task.h"
+#include "myplan/variables.h"
+
+// A truck drives between a and b and carries a package
+Task get_truck_task() {
+    std::vector<std::vector<std::string>> atoms = {{"at", "t", "a"},
+                                                   {"at", "t", "b"},
+                                                   {"at", "p", "a"},
+                                                   {"at", "p", "b"},
+                                                   {"in", "p", "t"}};
+    std::vector<int> v_ta = {0}, v_tb = {1}, v_pa = {2}, v_pb = {3},
+                     v_in = {4};
+    std::vector<int> v_ta_pa = {0, 2}, v_tb_pb = {1, 3}, v_ta_in = {0, 4},
+                     v_tb_in = {1, 4};
+    EncodedOperator drive_ab(10, v_ta, v_tb, v_ta);
+    EncodedOperator drive_ba(11, v_tb, v_ta, v_tb);
+    EncodedOperator load_a(12, v_ta_pa, v_in, v_pa);
+    EncodedOperator load_b(13, v_tb_pb, v_in, v_pb);
+    EncodedOperator unload_a(14, v_ta_in, v_pa, v_in);
+    EncodedOperator unload_b(15, v_tb_in, v_pb, v_in);
+    flat_hash_set<int> facts = {0, 1, 2, 3, 4};
+    flat_hash_set<int> init = {0, 2};
+    flat_hash_set<int> goals = {3};
+    Task task("truck", facts, init, goals,
+              {drive_ab, drive_ba, load_a, load_b, unload_a, unload_b});
+    for (const std::vector<std::string>& atom : atoms) {
+        std::vector<int> args = {task.symbols.objects.intern(atom[1]),
+                                 task.symbols.objects.intern(atom[2])};
+        task.fact_atoms.insert(task.symbols.predicates.intern(atom[0]), args);
+    }
+    return task;
+}
+
+TEST(VariableLayout, Widths) {
+    // 3 facts with "none" need 2 bits, 2 facts without it 1 bit
+    VariableLayout layout({{0, 1, 2}, {3, 4}, {5}}, {0, 1, 0}, 64);
+    ASSERT_EQ(layout.size(), 3);
+    ASSERT_EQ(layout.variables[0].bits, 2);
+    ASSERT_EQ(layout.variables[1].bits, 1);
+    ASSERT_EQ(layout.variables[2].bits, 1);
+    ASSERT_EQ(layout.packed_bits(), 4);
+    ASSERT_EQ(layout.packed_words(), 1);
+    ASSERT_EQ(layout.var_of[4], 1);
+    ASSERT_EQ(layout.value_of[4], 1);
+    ASSERT_EQ(layout.value_of[0], 1);
+}
+
+TEST(VariableLayout, NoStraddling) {
+    // 40 facts need 6 bits each, at most 10 of them fit into a word
+    std::vector<std::vector<int>> groups;
+    for (int v = 0; v < 11; v++) {
+        groups.emplace_back();
+        for (int i = 0; i < 40; i++) {
+            groups.back().push_back(v * 40 + i);
+        }
+    }
+    VariableLayout layout(groups, std::vector<char>(11, 0), 448);
+    ASSERT_EQ(layout.packed_bits(), 66);
+    ASSERT_EQ(layout.packed_words(), 2);
+    for (const VariableLayout::Variable& var : layout.variables) {
+        ASSERT_LE(var.shift + var.bits, STATE_WORD_BITS);
+    }
+}
+
+TEST(VariableLayout, PackUnpack) {
+    VariableLayout layout({{0, 1, 2}, {3, 4}, {5}, {70, 71}}, {0, 1, 0, 0},
+                          128);
+    PackedState state({2, 3, 71}, 2);
+    std::vector<StateWord> packed(layout.packed_words());
+    layout.pack(state, packed.data());
+    PackedState unpacked({}, 2);
+    layout.unpack(packed.data(), unpacked);
+    ASSERT_EQ(unpacked, state);
+
+    PackedState other({0, 4, 5}, 2);
+    layout.pack(other, packed.data());
+    layout.unpack(packed.data(), unpacked);
+    ASSERT_EQ(unpacked, other);
+}
+
+TEST(MutexGroups, Synthesis) {
+    Task task = get_truck_task();
+    std::vector<MutexGroup> groups = synthesize_mutex_groups(task);
+    std::vector<std::vector<int>> found;
+    for (MutexGroup& group : groups) {
+        ASSERT_TRUE(group.exactly_one);
+        found.push_back(group.facts);
+    }
+    std::sort(found.begin(), found.end());
+    // the package is at a, at b or in the truck
+    ASSERT_EQ(found, std::vector<std::vector<int>>({{0, 1}, {2, 3, 4}}));
+
+    VariableLayout layout = compute_variable_layout(task, groups);
+    ASSERT_EQ(layout.size(), 2);
+    ASSERT_EQ(layout.packed_bits(), 3);
+}
+
+TEST(MutexGroups, RejectsViolatedCandidates) {
+    Task task = get_truck_task();
+    // with the package at a and b initially, "at" grouped by its first
+    // argument is no invariant, and neither is any refinement of it
+    task.initial_state.insert(3);
+    std::vector<MutexGroup> groups = synthesize_mutex_groups(task);
+    ASSERT_TRUE(groups.empty());
+
+    // every fact becomes a binary variable
+    VariableLayout layout = compute_variable_layout(task, groups);
+    ASSERT_EQ(layout.size(), 5);
+    ASSERT_EQ(layout.packed_bits(), 5);
+}
+
+TEST(StateRegistry, PackedStates) {
+    VariableLayout layout({{0, 1, 2}, {3, 4}, {70}}, {0, 1, 0}, 128);
+    StateRegistry registry(2, layout);
+    ASSERT_EQ(registry.words_per_state(), 1);
+    PackedState s1({1, 3, 70}, 2);
+    PackedState s2({4}, 2);
+    auto [id1, new1] = registry.insert_state(s1, 7);
+    auto [id2, new2] = registry.insert_state(s2, 7);
+    auto [id3, new3] = registry.insert_state(s1, 7);
+    ASSERT_TRUE(new1);
+    ASSERT_TRUE(new2);
+    ASSERT_FALSE(new3);
+    ASSERT_EQ(id3, id1);
+    ASSERT_EQ(registry.get_state(id1), s1);
+    ASSERT_EQ(registry.get_state(id2), s2);
+}